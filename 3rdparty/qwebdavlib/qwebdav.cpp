@@ -56,115 +56,115 @@
 Q_LOGGING_CATEGORY(KDAV2_LOG, "org.kde.pim.kdav2.webdav")
 
 QWebdav::QWebdav (QObject *parent) : QNetworkAccessManager(parent)
-  ,m_rootPath()
   ,m_username()
   ,m_password()
-  ,m_baseUrl()
-  ,m_currentConnectionType(QWebdav::HTTP)
-  ,m_authenticator_lastReply(nullptr)
+  ,m_authenticationChallenges(0)
+  ,m_ignoreSslErrors(true)
 
 {
     qRegisterMetaType<QNetworkReply*>("QNetworkReply*");
 
     connect(this, SIGNAL(authenticationRequired(QNetworkReply*,QAuthenticator*)), this, SLOT(provideAuthenication(QNetworkReply*,QAuthenticator*)));
     connect(this, SIGNAL(sslErrors(QNetworkReply*,QList<QSslError>)), this, SLOT(sslErrors(QNetworkReply*,QList<QSslError>)));
+    connect(this, SIGNAL(finished(QNetworkReply*)), this, SLOT(replyFinished(QNetworkReply*)));
 }
 
 QWebdav::~QWebdav()
 {
 }
 
-QString QWebdav::hostname() const
+QString QWebdav::username() const
 {
-    return m_baseUrl.host();
+    return m_username;
 }
 
-int QWebdav::port() const
+QString QWebdav::password() const
 {
-    return m_baseUrl.port();
+    return m_password;
 }
 
-QString QWebdav::rootPath() const
+void QWebdav::setCredentials(const QString &username, const QString &password)
 {
-    return m_rootPath;
+    m_username = username;
+    m_password = password;
 }
 
-QString QWebdav::username() const
+QString QWebdav::bearerToken() const
 {
-    return m_username;
+    return m_bearerToken;
 }
 
-QString QWebdav::password() const
+void QWebdav::setBearerToken(const QString &token)
 {
-    return m_password;
+    m_bearerToken = token;
 }
 
-QWebdav::QWebdavConnectionType QWebdav::connectionType() const
+int QWebdav::authenticationChallengeCount() const
 {
-    return m_currentConnectionType;
+    return m_authenticationChallenges;
 }
 
-bool QWebdav::isSSL() const
+bool QWebdav::ignoreSslErrors() const
 {
-    return (m_currentConnectionType==QWebdav::HTTPS);
+    return m_ignoreSslErrors;
 }
 
-void QWebdav::setConnectionSettings(const QWebdavConnectionType connectionType,
-                                    const QString& hostname,
-                                    const QString& rootPath,
-                                    const QString& username,
-                                    const QString& password,
-                                    int port,
-                                    bool ignoreSslErrors)
+void QWebdav::setIgnoreSslErrors(bool ignoreSslErrors)
 {
-    m_rootPath = rootPath;
-
-    if ((m_rootPath.size()>0) && (m_rootPath.endsWith("/")))
-        m_rootPath.chop(1);
-
-    QString uriScheme;
-    switch (connectionType)
-    {
-    case QWebdav::HTTP:
-        uriScheme = "http";
-        break;
-    case QWebdav::HTTPS:
-        uriScheme = "https";
-        break;
-    }
-
-    m_currentConnectionType = connectionType;
-
-    m_baseUrl.setScheme(uriScheme);
-    m_baseUrl.setHost(hostname);
-    m_baseUrl.setPath(rootPath);
-
-    if (port != 0) {
-
-        // use user-defined port number
-        if ( ! ( ( (port == 80) && (m_currentConnectionType==QWebdav::HTTP) ) ||
-               ( (port == 443) && (m_currentConnectionType==QWebdav::HTTPS) ) ) )
-            m_baseUrl.setPort(port);
-    }
-
     m_ignoreSslErrors = ignoreSslErrors;
-
-    m_username = username;
-    m_password = password;
 }
 
 void QWebdav::provideAuthenication(QNetworkReply *reply, QAuthenticator *authenticator)
 {
     qCDebug(KDAV2_LOG) << "QWebdav::authenticationRequired()  option == " << authenticator->options();
 
-    if (reply == m_authenticator_lastReply) {
+    if (reply->property("authenticationProvided").toBool()) {
         //Avoid endless retries. This will fail with AuthenticationRequiredError
         return;
     }
-    m_authenticator_lastReply = reply;
+    reply->setProperty("authenticationProvided", true);
+    ++m_authenticationChallenges;
+
+    const QNetworkRequest req = reply->request();
+
+    // Send the credentials right away to this origin from now on, unless
+    // it has rejected them already, e.g. because it uses Digest. Digest
+    // nonces are reused by the authentication cache of the connections.
+    const QString replyOrigin = origin(reply->url());
+    if (req.attribute(static_cast<QNetworkRequest::Attribute>(CookieAuthAttribute)).toBool()) {
+        // The cookies no longer do, e.g. because the session expired
+        m_cookieAuthOrigins.remove(replyOrigin);
+    }
+    if (req.attribute(static_cast<QNetworkRequest::Attribute>(PreemptiveAuthAttribute)).toBool()) {
+        qCDebug(KDAV2_LOG) << "QWebdav: preemptive Basic authentication rejected by" << replyOrigin;
+        m_basicAuthOrigins.remove(replyOrigin);
+        m_noPreemptiveAuthOrigins.insert(replyOrigin);
+    } else if (!m_noPreemptiveAuthOrigins.contains(replyOrigin)) {
+        m_basicAuthOrigins.insert(replyOrigin);
+    }
 
-    authenticator->setUser(m_username);
-    authenticator->setPassword(m_password);
+    const QVariant username = req.attribute(static_cast<QNetworkRequest::Attribute>(UserNameAttribute));
+    if (username.isValid()) {
+        authenticator->setUser(username.toString());
+        authenticator->setPassword(req.attribute(static_cast<QNetworkRequest::Attribute>(PasswordAttribute)).toString());
+    } else {
+        authenticator->setUser(m_username);
+        authenticator->setPassword(m_password);
+    }
+}
+
+void QWebdav::replyFinished(QNetworkReply *reply)
+{
+    const QNetworkRequest req = reply->request();
+    if (!req.attribute(static_cast<QNetworkRequest::Attribute>(CookieAuthAttribute)).toBool()
+        || reply->property("authenticationProvided").toBool()) {
+        return;
+    }
+
+    const int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (statusCode >= 200 && statusCode < 400) {
+        m_cookieAuthOrigins.insert(origin(req.url()));
+    }
 }
 
 void QWebdav::sslErrors(QNetworkReply *reply, const QList<QSslError> &)
@@ -177,10 +177,64 @@ void QWebdav::sslErrors(QNetworkReply *reply, const QList<QSslError> &)
     }
 }
 
-QString QWebdav::absolutePath(const QString &relPath)
+QNetworkRequest QWebdav::prepareRequest(const QUrl &url) const
 {
-    return QString(m_rootPath + relPath);
+    QUrl reqUrl(url);
+    reqUrl.setUserInfo(QString());
+    reqUrl.setFragment(QString());
+
+    QNetworkRequest req(reqUrl);
+    if (!url.userName().isEmpty()) {
+        req.setAttribute(static_cast<QNetworkRequest::Attribute>(UserNameAttribute), url.userName());
+        req.setAttribute(static_cast<QNetworkRequest::Attribute>(PasswordAttribute), url.password());
+    }
 
+    addPreemptiveAuthorization(req);
+    return req;
+}
+
+void QWebdav::addPreemptiveAuthorization(QNetworkRequest &req) const
+{
+    const QVariant username = req.attribute(static_cast<QNetworkRequest::Attribute>(UserNameAttribute));
+    if (!username.isValid() && !m_bearerToken.isEmpty()) {
+        req.setRawHeader("Authorization", "Bearer " + m_bearerToken.toUtf8());
+        return;
+    }
+
+    // A session cookie is cheaper for the server to verify than the
+    // credentials, but only once it has been accepted on its own. The
+    // credentials are still sent if the server challenges the request.
+    const bool hasCookies = !cookieJar()->cookiesForUrl(req.url()).isEmpty();
+    const QString reqOrigin = origin(req.url());
+
+    // Basic credentials are only sent unasked over TLS, where they can't
+    // leak to a server that actually wants Digest
+    if (req.url().scheme() != QLatin1String("https") || !m_basicAuthOrigins.contains(reqOrigin)
+        || (hasCookies && m_cookieAuthOrigins.contains(reqOrigin))) {
+        if (hasCookies) {
+            req.setAttribute(static_cast<QNetworkRequest::Attribute>(CookieAuthAttribute), true);
+        }
+        return;
+    }
+
+    QString user = m_username;
+    QString password = m_password;
+    if (username.isValid()) {
+        user = username.toString();
+        password = req.attribute(static_cast<QNetworkRequest::Attribute>(PasswordAttribute)).toString();
+    }
+    if (user.isEmpty()) {
+        return;
+    }
+
+    const QByteArray credentials = QString(user + QLatin1Char(':') + password).toUtf8().toBase64();
+    req.setRawHeader("Authorization", "Basic " + credentials);
+    req.setAttribute(static_cast<QNetworkRequest::Attribute>(PreemptiveAuthAttribute), true);
+}
+
+QString QWebdav::origin(const QUrl &url)
+{
+    return url.adjusted(QUrl::RemoveUserInfo | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment).toString();
 }
 
 QNetworkReply* QWebdav::createDAVRequest(const QString& method, QNetworkRequest& req, const QByteArray& outgoingData)
@@ -207,7 +261,7 @@ QNetworkReply* QWebdav::createDAVRequest(const QString& method, QNetworkRequest&
     return reply;
 }
 
-QNetworkReply* QWebdav::list(const QString& path, int depth)
+QNetworkReply* QWebdav::list(const QUrl& url, int depth)
 {
     QWebdav::PropNames query;
     QStringList props;
@@ -238,32 +292,24 @@ QNetworkReply* QWebdav::list(const QString& path, int depth)
 
     query["DAV:"] = props;
 
-    return propfind(path, query, depth);
+    return propfind(url, query, depth);
 }
 
-QNetworkReply* QWebdav::search(const QString& path, const QString& q )
+QNetworkReply* QWebdav::search(const QUrl& url, const QString& q )
 {
     QByteArray query = "<?xml version=\"1.0\"?>\r\n";
     query.append( "<D:searchrequest xmlns:D=\"DAV:\">\r\n" );
     query.append( q.toUtf8() );
     query.append( "</D:searchrequest>\r\n" );
 
-    QNetworkRequest req;
-
-    QUrl reqUrl(m_baseUrl);
-    reqUrl.setPath(absolutePath(path));
-
-    req.setUrl(reqUrl);
+    QNetworkRequest req = prepareRequest(url);
 
     return this->createDAVRequest("SEARCH", req, query);
 }
 
-QNetworkReply* QWebdav::get(const QString& path, const QMap<QByteArray, QByteArray> &headers)
+QNetworkReply* QWebdav::get(const QUrl& url, const QMap<QByteArray, QByteArray> &headers)
 {
-    QNetworkRequest req;
-
-    QUrl reqUrl(m_baseUrl);
-    reqUrl.setPath(absolutePath(path));
+    QNetworkRequest req = prepareRequest(url);
 
     for (auto it = headers.constBegin(); it != headers.constEnd(); it++) {
         req.setRawHeader(it.key(), it.value());
@@ -271,19 +317,12 @@ QNetworkReply* QWebdav::get(const QString& path, const QMap<QByteArray, QByteArr
 
     qCDebug(KDAV2_LOG) << "QWebdav::get() url = " << req.url().toString(QUrl::RemoveUserInfo);
 
-    req.setUrl(reqUrl);
-
     return QNetworkAccessManager::get(req);
 }
 
-QNetworkReply* QWebdav::put(const QString& path, const QByteArray& data, const QMap<QByteArray, QByteArray> &headers)
+QNetworkReply* QWebdav::put(const QUrl& url, const QByteArray& data, const QMap<QByteArray, QByteArray> &headers)
 {
-    QNetworkRequest req;
-
-    QUrl reqUrl(m_baseUrl);
-    reqUrl.setPath(absolutePath(path));
-
-    req.setUrl(reqUrl);
+    QNetworkRequest req = prepareRequest(url);
     for (auto it = headers.constBegin(); it != headers.constEnd(); it++) {
         req.setRawHeader(it.key(), it.value());
     }
@@ -297,7 +336,7 @@ QNetworkReply* QWebdav::put(const QString& path, const QByteArray& data, const Q
 }
 
 
-QNetworkReply* QWebdav::propfind(const QString& path, const QWebdav::PropNames& props, int depth)
+QNetworkReply* QWebdav::propfind(const QUrl& url, const QWebdav::PropNames& props, int depth)
 {
     QByteArray query;
 
@@ -314,37 +353,27 @@ QNetworkReply* QWebdav::propfind(const QString& path, const QWebdav::PropNames&
     }
     query += "</D:prop>";
     query += "</D:propfind>";
-    return propfind(path, query, depth);
+    return propfind(url, query, depth);
 }
 
 
-QNetworkReply* QWebdav::propfind(const QString& path, const QByteArray& query, int depth)
+QNetworkReply* QWebdav::propfind(const QUrl& url, const QByteArray& query, int depth)
 {
-    QNetworkRequest req;
-
-    QUrl reqUrl(m_baseUrl);
-    reqUrl.setPath(absolutePath(path));
-
-    req.setUrl(reqUrl);
+    QNetworkRequest req = prepareRequest(url);
     req.setRawHeader("Depth", depth == 2 ? QString("infinity").toUtf8() : QString::number(depth).toUtf8());
 
     return createDAVRequest("PROPFIND", req, query);
 }
 
-QNetworkReply* QWebdav::report(const QString& path, const QByteArray& query, int depth)
+QNetworkReply* QWebdav::report(const QUrl& url, const QByteArray& query, int depth)
 {
-    QNetworkRequest req;
-
-    QUrl reqUrl(m_baseUrl);
-    reqUrl.setPath(absolutePath(path));
-
-    req.setUrl(reqUrl);
+    QNetworkRequest req = prepareRequest(url);
     req.setRawHeader("Depth", depth == 2 ? QString("infinity").toUtf8() : QString::number(depth).toUtf8());
 
     return createDAVRequest("REPORT", req, query);
 }
 
-QNetworkReply* QWebdav::proppatch(const QString& path, const QWebdav::PropValues& props)
+QNetworkReply* QWebdav::proppatch(const QUrl& url, const QWebdav::PropValues& props)
 {
     QByteArray query;
 
@@ -370,73 +399,47 @@ QNetworkReply* QWebdav::proppatch(const QString& path, const QWebdav::PropValues
     query += "</D:prop>";
     query += "</D:propfind>";
 
-    return proppatch(path, query);
+    return proppatch(url, query);
 }
 
-QNetworkReply* QWebdav::proppatch(const QString& path, const QByteArray& query)
+QNetworkReply* QWebdav::proppatch(const QUrl& url, const QByteArray& query)
 {
-    QNetworkRequest req;
-
-    QUrl reqUrl(m_baseUrl);
-    reqUrl.setPath(absolutePath(path));
-
-    req.setUrl(reqUrl);
+    QNetworkRequest req = prepareRequest(url);
 
     return createDAVRequest("PROPPATCH", req, query);
 }
 
-QNetworkReply* QWebdav::mkdir (const QString& path)
+QNetworkReply* QWebdav::mkdir(const QUrl& url)
 {
-    QNetworkRequest req;
-
-    QUrl reqUrl(m_baseUrl);
-    reqUrl.setPath(absolutePath(path));
-
-    req.setUrl(reqUrl);
+    QNetworkRequest req = prepareRequest(url);
 
     return createDAVRequest("MKCOL", req);
 }
 
-QNetworkReply* QWebdav::mkdir (const QString& path, const QByteArray& query)
+QNetworkReply* QWebdav::mkdir(const QUrl& url, const QByteArray& query)
 {
-    QNetworkRequest req;
-
-    QUrl reqUrl(m_baseUrl);
-    reqUrl.setPath(absolutePath(path));
-
-    req.setUrl(reqUrl);
+    QNetworkRequest req = prepareRequest(url);
 
     return createDAVRequest("MKCOL", req, query);
 }
 
-QNetworkReply* QWebdav::mkcalendar (const QString& path, const QByteArray& query)
+QNetworkReply* QWebdav::mkcalendar(const QUrl& url, const QByteArray& query)
 {
-    QNetworkRequest req;
-
-    QUrl reqUrl(m_baseUrl);
-    reqUrl.setPath(absolutePath(path));
-
-    req.setUrl(reqUrl);
+    QNetworkRequest req = prepareRequest(url);
 
     return createDAVRequest("MKCALENDAR", req, query);
 }
 
-QNetworkReply* QWebdav::copy(const QString& pathFrom, const QString& pathTo, bool overwrite)
+QNetworkReply* QWebdav::copy(const QUrl& from, const QUrl& to, bool overwrite)
 {
-    QNetworkRequest req;
-
-    QUrl reqUrl(m_baseUrl);
-    reqUrl.setPath(absolutePath(pathFrom));
-
-    req.setUrl(reqUrl);
+    QNetworkRequest req = prepareRequest(from);
 
     // RFC4918 Section 10.3 requires an absolute URI for destination raw header
     //  http://tools.ietf.org/html/rfc4918#section-10.3
     // RFC3986 Section 4.3 specifies the term absolute URI
     //  http://tools.ietf.org/html/rfc3986#section-4.3
-    QUrl dstUrl(m_baseUrl);
-    //dstUrl.setUserInfo("");
-    dstUrl.setPath(absolutePath(pathTo));
+    QUrl dstUrl(to);
+    dstUrl.setUserInfo(QString());
     req.setRawHeader("Destination", dstUrl.toString().toUtf8());
 
     req.setRawHeader("Depth", "infinity");
@@ -445,22 +448,16 @@ QNetworkReply* QWebdav::copy(const QString& pathFrom, const QString& pathTo, boo
     return createDAVRequest("COPY", req);
 }
 
-QNetworkReply* QWebdav::move(const QString& pathFrom, const QString& pathTo, bool overwrite)
+QNetworkReply* QWebdav::move(const QUrl& from, const QUrl& to, bool overwrite)
 {
-    QNetworkRequest req;
-
-    QUrl reqUrl(m_baseUrl);
-    reqUrl.setPath(absolutePath(pathFrom));
-
-    req.setUrl(reqUrl);
+    QNetworkRequest req = prepareRequest(from);
 
     // RFC4918 Section 10.3 requires an absolute URI for destination raw header
     //  http://tools.ietf.org/html/rfc4918#section-10.3
     // RFC3986 Section 4.3 specifies the term absolute URI
     //  http://tools.ietf.org/html/rfc3986#section-4.3
-    QUrl dstUrl(m_baseUrl);
-    //dstUrl.setUserInfo("");
-    dstUrl.setPath(absolutePath(pathTo));
+    QUrl dstUrl(to);
+    dstUrl.setUserInfo(QString());
     req.setRawHeader("Destination", dstUrl.toString().toUtf8());
 
     req.setRawHeader("Depth", "infinity");
@@ -469,14 +466,9 @@ QNetworkReply* QWebdav::move(const QString& pathFrom, const QString& pathTo, boo
     return createDAVRequest("MOVE", req);
 }
 
-QNetworkReply* QWebdav::remove(const QString& path)
+QNetworkReply* QWebdav::remove(const QUrl& url)
 {
-    QNetworkRequest req;
-
-    QUrl reqUrl(m_baseUrl);
-    reqUrl.setPath(absolutePath(path));
-
-    req.setUrl(reqUrl);
+    QNetworkRequest req = prepareRequest(url);
 
     return createDAVRequest("DELETE", req);
 }
@@ -73,65 +73,87 @@ public:
     typedef QMap<QString, QStringList > PropNames;
 
 
-    QString hostname() const;
-    int port() const;
-    QString rootPath() const;
+    /**
+     * Request attributes holding the credentials used to answer an
+     * authentication challenge for a single request. They are taken from
+     * the user info of the request url.
+     */
+    enum RequestAttribute {
+        UserNameAttribute = QNetworkRequest::User + 1,
+        PasswordAttribute,
+        //! Set on requests that carry Basic credentials before being challenged
+        PreemptiveAuthAttribute,
+        //! Set on requests that rely on the cookies of the jar alone to authenticate
+        CookieAuthAttribute
+    };
+
     QString username() const;
     QString password() const;
-    QWebdavConnectionType connectionType() const;
-    bool isSSL() const;
 
-    void setConnectionSettings( const QWebdavConnectionType connectionType,
-                            const QString &hostname,
-                            const QString &rootPath = "/",
-                            const QString &username = "",
-                            const QString &password = "",
-                            int port = 0,
-                            bool ignoreSslErrors = true);
+    //! Sets the credentials used for requests whose url has no user info
+    void setCredentials(const QString &username, const QString &password);
+
+    QString bearerToken() const;
+    //! Sets a token sent in a Bearer Authorization header with every request whose url has no user info
+    void setBearerToken(const QString &token);
+
+    //! Returns the number of authentication challenges received so far
+    int authenticationChallengeCount() const;
+
+    bool ignoreSslErrors() const;
+    void setIgnoreSslErrors(bool ignoreSslErrors);
 
-    QNetworkReply* list(const QString& path, int depth = 1);
+    QNetworkReply* list(const QUrl& url, int depth = 1);
 
-    QNetworkReply* search(const QString& path, const QString& query);
+    QNetworkReply* search(const QUrl& url, const QString& query);
 
-    QNetworkReply* get(const QString& path, const QMap<QByteArray, QByteArray> &headers);
+    QNetworkReply* get(const QUrl& url, const QMap<QByteArray, QByteArray> &headers);
 
-    QNetworkReply* put(const QString& path, const QByteArray& data, const QMap<QByteArray, QByteArray> &headers);
+    QNetworkReply* put(const QUrl& url, const QByteArray& data, const QMap<QByteArray, QByteArray> &headers);
 
-    QNetworkReply* mkdir(const QString& dir );
+    QNetworkReply* mkdir(const QUrl& url);
     // The extended MKCOL used in CardDAV
-    QNetworkReply* mkdir(const QString& dir, const QByteArray& query);
-    QNetworkReply* mkcalendar(const QString& dir, const QByteArray& query);
-    QNetworkReply* copy(const QString& pathFrom, const QString& pathTo, bool overwrite = false);
-    QNetworkReply* move(const QString& pathFrom, const QString& pathTo, bool overwrite = false);
-    QNetworkReply* remove(const QString& path );
+    QNetworkReply* mkdir(const QUrl& url, const QByteArray& query);
+    QNetworkReply* mkcalendar(const QUrl& url, const QByteArray& query);
+    QNetworkReply* copy(const QUrl& from, const QUrl& to, bool overwrite = false);
+    QNetworkReply* move(const QUrl& from, const QUrl& to, bool overwrite = false);
+    QNetworkReply* remove(const QUrl& url);
 
-    QNetworkReply* propfind(const QString& path, const QByteArray& query, int depth = 0);
-    QNetworkReply* propfind(const QString& path, const QWebdav::PropNames& props, int depth = 0);
+    QNetworkReply* propfind(const QUrl& url, const QByteArray& query, int depth = 0);
+    QNetworkReply* propfind(const QUrl& url, const QWebdav::PropNames& props, int depth = 0);
 
-    QNetworkReply* report(const QString& path, const QByteArray& query, int depth = 0);
+    QNetworkReply* report(const QUrl& url, const QByteArray& query, int depth = 0);
 
-    QNetworkReply* proppatch(const QString& path, const QWebdav::PropValues& props);
-    QNetworkReply* proppatch(const QString& path, const QByteArray& query);
+    QNetworkReply* proppatch(const QUrl& url, const QWebdav::PropValues& props);
+    QNetworkReply* proppatch(const QUrl& url, const QByteArray& query);
 
 protected Q_SLOTS:
     void provideAuthenication(QNetworkReply* reply, QAuthenticator* authenticator);
+    void replyFinished(QNetworkReply* reply);
     void sslErrors(QNetworkReply *reply,const QList<QSslError> &errors);
 
 protected:
     QNetworkReply* createDAVRequest(const QString& method, QNetworkRequest& req, const QByteArray& outgoingData = {});
 
-    //! creates the absolute path from m_rootPath and relPath
-    QString absolutePath(const QString &relPath);
+    //! creates a request for url, moving its user info to the request attributes
+    QNetworkRequest prepareRequest(const QUrl &url) const;
+
+    //! adds the credentials to req if its origin is known to require them
+    void addPreemptiveAuthorization(QNetworkRequest &req) const;
 
 private:
-    QString m_rootPath;
+    static QString origin(const QUrl &url);
+
     QString m_username;
     QString m_password;
-    QUrl m_baseUrl;
-
-    QWebdavConnectionType m_currentConnectionType;
-
-    QNetworkReply *m_authenticator_lastReply;
+    QString m_bearerToken;
+
+    // Origins that challenged a request, and those that didn't accept Basic credentials
+    QSet<QString> m_basicAuthOrigins;
+    QSet<QString> m_noPreemptiveAuthOrigins;
+    // Origins that answered a request authenticated by cookies alone
+    QSet<QString> m_cookieAuthOrigins;
+    int m_authenticationChallenges;
 
     bool m_ignoreSslErrors;
 };
@@ -18,6 +18,7 @@
 */
 
 #include "davcollectioncreatejobtest.h"
+#include "fakeserver.h"
 
 #include <KDAV2/DavCollectionCreateJob>
 #include <KDAV2/DavCollectionDeleteJob>
@@ -51,6 +52,7 @@ void DavCollectionCreateJobTest::runAddressbookTest()
     testCollection.setUrl(testCollectionUrl);
 
     auto collectionCreateJob = new KDAV2::DavCollectionCreateJob(testCollection);
+    collectionCreateJob->setFetchAfterCreation(true);
     collectionCreateJob->exec();
 
     QCOMPARE(collectionCreateJob->error(), 0);
@@ -74,6 +76,7 @@ void DavCollectionCreateJobTest::runCalendarTest()
     testCollection.setColor("#123456");
 
     auto collectionCreateJob = new KDAV2::DavCollectionCreateJob(testCollection);
+    collectionCreateJob->setFetchAfterCreation(true);
     collectionCreateJob->exec();
 
     QCOMPARE(collectionCreateJob->error(), 0);
@@ -89,6 +92,35 @@ void DavCollectionCreateJobTest::runCalendarTest()
     delete collectionCreateJob;
 }
 
+void DavCollectionCreateJobTest::runSingleRequestCalendarTest()
+{
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/calendars/test/work/"));
+    url.setPort(fakeServer.port());
+
+    KDAV2::DavCollection testCollection(KDAV2::DavUrl(url, KDAV2::CalDav), QStringLiteral("Work"), KDAV2::DavCollection::Events);
+    testCollection.setColor(QColor(QStringLiteral("#123456")));
+
+    auto collectionCreateJob = new KDAV2::DavCollectionCreateJob(testCollection);
+
+    // Only the MKCALENDAR request is sent, the collection is not fetched afterwards
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectioncreatejob.txt"));
+    fakeServer.startAndWait();
+    collectionCreateJob->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(collectionCreateJob->error(), 0);
+
+    const KDAV2::DavCollection resultCollection = collectionCreateJob->collection();
+    QCOMPARE(resultCollection.url().url(), url);
+    QCOMPARE(resultCollection.displayName(), QStringLiteral("Work"));
+    QCOMPARE(resultCollection.color().name(), QStringLiteral("#123456"));
+    QCOMPARE(resultCollection.contentTypes(), KDAV2::DavCollection::ContentTypes(KDAV2::DavCollection::Events));
+
+    delete collectionCreateJob;
+}
+
 void DavCollectionCreateJobTest::cleanupTestCase()
 {
     {
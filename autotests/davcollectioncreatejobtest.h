@@ -38,6 +38,7 @@ private Q_SLOTS:
     void runNormalCollectionTest();
     void runAddressbookTest();
     void runCalendarTest();
+    void runSingleRequestCalendarTest();
 
     void cleanupTestCase();
 };
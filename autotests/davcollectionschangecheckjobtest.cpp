@@ -0,0 +1,125 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#include "davcollectionschangecheckjobtest.h"
+#include "fakeserver.h"
+
+#include <KDAV2/DavCollectionsChangeCheckJob>
+#include <KDAV2/DavSession>
+
+#include <QTest>
+
+void DavCollectionsChangeCheckJobTest::checkHomeSet()
+{
+    FakeServer fakeServer;
+    QUrl baseUrl(QStringLiteral("http://localhost/calendars/test/"));
+    baseUrl.setPort(fakeServer.port());
+
+    const QUrl workUrl = baseUrl.resolved(QUrl(QStringLiteral("work/")));
+    const QUrl homeUrl = baseUrl.resolved(QUrl(QStringLiteral("home/")));
+    const QUrl goneUrl = baseUrl.resolved(QUrl(QStringLiteral("gone/")));
+
+    QMap<QUrl, QString> knownTags;
+    knownTags.insert(workUrl, QStringLiteral("http://example.com/sync/1"));
+    knownTags.insert(homeUrl, QStringLiteral("5"));
+    knownTags.insert(goneUrl, QStringLiteral("3"));
+
+    auto job = new KDAV2::DavCollectionsChangeCheckJob(KDAV2::CalDav, knownTags);
+
+    // One request for the home set, and one for the collection missing from it
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionschangecheckjob1.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionschangecheckjob2.txt"));
+    fakeServer.startAndWait();
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+
+    const auto changed = job->changedCollections();
+    QCOMPARE(changed.size(), 1);
+    QCOMPARE(changed.at(0).url(), homeUrl);
+    QCOMPARE(job->cTag(homeUrl), QStringLiteral("6"));
+    QCOMPARE(job->syncToken(homeUrl), QString());
+    QCOMPARE(job->syncToken(workUrl), QStringLiteral("http://example.com/sync/1"));
+
+    const auto removed = job->removedCollections();
+    QCOMPARE(removed.size(), 1);
+    QCOMPARE(removed.at(0).url(), goneUrl);
+}
+
+void DavCollectionsChangeCheckJobTest::listingWithoutTags_data()
+{
+    QTest::addColumn<bool>("knownQuirk");
+
+    QTest::newRow("found while listing") << false;
+    QTest::newRow("known before") << true;
+}
+
+void DavCollectionsChangeCheckJobTest::listingWithoutTags()
+{
+    QFETCH(bool, knownQuirk);
+
+    KDAV2::DavSession session;
+    // One request at a time, so that the scenarios come in order
+    session.setMaxRequestsPerHost(1);
+
+    FakeServer fakeServer;
+    QUrl baseUrl(QStringLiteral("http://localhost/calendars/test/"));
+    baseUrl.setPort(fakeServer.port());
+    if (knownQuirk) {
+        session.addServerQuirk(baseUrl, KDAV2::DavSession::NoCTagInListing);
+    }
+
+    // The user name is percent encoded in the listing only
+    const QUrl homeUrl = baseUrl.resolved(QUrl(QStringLiteral("home@example/")));
+    const QUrl workUrl = baseUrl.resolved(QUrl(QStringLiteral("work/")));
+
+    QMap<QUrl, QString> knownTags;
+    knownTags.insert(homeUrl, QStringLiteral("5"));
+    knownTags.insert(workUrl, QStringLiteral("1"));
+
+    auto job = new KDAV2::DavCollectionsChangeCheckJob(KDAV2::CalDav, knownTags);
+    job->setSession(&session);
+
+    // The home set lists the collections without their tags, which are
+    // then asked for from the collections themselves
+    if (!knownQuirk) {
+        fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionschangecheckjob3.txt"));
+    }
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionschangecheckjob4.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionschangecheckjob5.txt"));
+    fakeServer.startAndWait();
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+
+    // Only the collection whose CTag moved is reported, not every collection
+    // listed without tags
+    const auto changed = job->changedCollections();
+    QCOMPARE(changed.size(), 1);
+    QCOMPARE(changed.at(0).url(), homeUrl);
+    QCOMPARE(job->cTag(homeUrl), QStringLiteral("6"));
+    QCOMPARE(job->cTag(workUrl), QStringLiteral("1"));
+    QVERIFY(job->removedCollections().isEmpty());
+}
+
+QTEST_GUILESS_MAIN(DavCollectionsChangeCheckJobTest)
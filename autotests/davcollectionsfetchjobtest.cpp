@@ -0,0 +1,180 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include "davcollectionsfetchjobtest.h"
+#include "fakeserver.h"
+
+#include <KDAV2/DavCollectionsFetchJob>
+#include <KDAV2/DavDiscoveryCache>
+#include <KDAV2/DavSession>
+#include <KDAV2/DavUrl>
+
+#include <QTemporaryDir>
+#include <QTest>
+#include <QTimer>
+
+void DavCollectionsFetchJobTest::refreshConcurrency_data()
+{
+    QTest::addColumn<bool>("knownQuirk");
+
+    QTest::newRow("found while listing") << false;
+    QTest::newRow("known before") << true;
+}
+
+void DavCollectionsFetchJobTest::refreshConcurrency()
+{
+    QFETCH(bool, knownQuirk);
+
+    KDAV2::DavSession session;
+
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/dav/"));
+    url.setPort(fakeServer.port());
+    if (knownQuirk) {
+        session.addServerQuirk(url, KDAV2::DavSession::NoCTagInListing);
+    }
+
+    // The home set lists four calendars without CTag, which are then
+    // fetched from the calendars themselves, two at a time
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsfetchjob1.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsfetchjob2.txt"));
+    for (int i = 0; i < 4; ++i) {
+        fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsfetchjob3.txt"));
+    }
+    fakeServer.startAndWait();
+
+    auto job = new KDAV2::DavCollectionsFetchJob(KDAV2::DavUrl(url, KDAV2::CalDav));
+    job->setSession(&session);
+    job->setMaxConcurrentRefreshes(2);
+    job->setAutoDelete(false);
+
+    // The refreshes are queued all at once, between two turns of the event loop
+    int maxRequests = 0;
+    QTimer poll;
+    connect(&poll, &QTimer::timeout, [&] () {
+        maxRequests = qMax(maxRequests, session.runningRequestCount() + session.queuedRequestCount());
+    });
+    poll.start(0);
+    job->exec();
+    poll.stop();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+    QCOMPARE(job->collections().size(), 4);
+    foreach (const KDAV2::DavCollection &collection, job->collections()) {
+        QCOMPARE(collection.CTag(), QStringLiteral("7"));
+    }
+    QVERIFY(session.serverQuirks(url).testFlag(KDAV2::DavSession::NoCTagInListing));
+
+    // With the quirk known the listing may still be running meanwhile
+    QVERIFY(maxRequests >= 1);
+    QVERIFY(maxRequests <= (knownQuirk ? 3 : 2));
+    delete job;
+}
+
+void DavCollectionsFetchJobTest::partialCTags_data()
+{
+    QTest::addColumn<bool>("knownQuirk");
+
+    QTest::newRow("unknown") << false;
+    QTest::newRow("known before") << true;
+}
+
+void DavCollectionsFetchJobTest::partialCTags()
+{
+    QFETCH(bool, knownQuirk);
+
+    KDAV2::DavSession session;
+
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/dav/"));
+    url.setPort(fakeServer.port());
+    if (knownQuirk) {
+        session.addServerQuirk(url, KDAV2::DavSession::NoCTagInListing);
+    }
+
+    // Only the second calendar is listed without CTag, e.g. a new one, and
+    // is the only one fetched on its own
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsfetchjob1.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsfetchjob4.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsfetchjob3.txt"));
+    fakeServer.startAndWait();
+
+    auto job = new KDAV2::DavCollectionsFetchJob(KDAV2::DavUrl(url, KDAV2::CalDav));
+    job->setSession(&session);
+    job->setAutoDelete(false);
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+    QCOMPARE(job->collections().size(), 2);
+
+    // The server lists CTags, so it isn't marked, or not anymore
+    QVERIFY(!session.serverQuirks(url).testFlag(KDAV2::DavSession::NoCTagInListing));
+    delete job;
+}
+
+void DavCollectionsFetchJobTest::additionalHomeSetsCached()
+{
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    KDAV2::DavDiscoveryCache cache(cacheDir.path());
+
+    QUrl url(QStringLiteral("http://localhost/dav/"));
+
+    {
+        KDAV2::DavSession session;
+        session.setDiscoveryCache(&cache);
+
+        // The CardDav home set comes along with the CalDav one
+        FakeServer fakeServer;
+        url.setPort(fakeServer.port());
+        fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsmultifetchjob5.txt"));
+        fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsmultifetchjob6.txt"));
+        fakeServer.startAndWait();
+
+        auto job = new KDAV2::DavCollectionsFetchJob(KDAV2::DavUrl(url, KDAV2::CalDav));
+        job->setSession(&session);
+        job->setAdditionalProtocols(QList<KDAV2::Protocol>() << KDAV2::CardDav);
+        job->exec();
+        fakeServer.quit();
+
+        QVERIFY(fakeServer.isAllScenarioDone());
+        QCOMPARE(job->error(), 0);
+    }
+
+    // A new session finds it in the cache and only lists it
+    KDAV2::DavSession session;
+    session.setDiscoveryCache(&cache);
+
+    FakeServer fakeServer;
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsmultifetchjob7.txt"));
+    fakeServer.startAndWait();
+
+    auto job = new KDAV2::DavCollectionsFetchJob(KDAV2::DavUrl(url, KDAV2::CardDav));
+    job->setSession(&session);
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+}
+
+QTEST_GUILESS_MAIN(DavCollectionsFetchJobTest)
@@ -0,0 +1,138 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#include "davcollectionsfilterbenchmark.h"
+
+#include <KDAV2/DavManager>
+#include <KDAV2/DavMultistatusReader>
+#include <KDAV2/DavProtocolBase>
+
+#include <QTest>
+#include <QtXml/QDomDocument>
+
+#ifdef HAVE_XMLPATTERNS
+#include <QtCore/QBuffer>
+#include <QtXmlPatterns/QXmlQuery>
+#endif
+
+// Number of calendars and of other resources in the home set
+static const int calendarCount = 400;
+static const int otherCount = 100;
+
+void DavCollectionsFilterBenchmark::initTestCase()
+{
+    mHomeSet = "<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n"
+               "<D:multistatus xmlns:D=\"DAV:\" xmlns:C=\"urn:ietf:params:xml:ns:caldav\" xmlns:CS=\"http://calendarserver.org/ns/\">\n";
+
+    for (int i = 0; i < calendarCount + otherCount; ++i) {
+        const bool isCalendar = i < calendarCount;
+        const QByteArray number = QByteArray::number(i);
+
+        mHomeSet += "  <D:response>\n"
+                    "    <D:href>/calendars/test/collection" + number + "/</D:href>\n"
+                    "    <D:propstat>\n"
+                    "      <D:prop>\n"
+                    "        <C:supported-calendar-component-set>\n"
+                    "          <C:comp name=\"VEVENT\"/>\n"
+                    "          <C:comp name=\"VTODO\"/>\n"
+                    "        </C:supported-calendar-component-set>\n"
+                    "        <D:resourcetype>\n"
+                    "          <D:collection/>\n";
+        if (isCalendar) {
+            mHomeSet += "          <C:calendar/>\n";
+        }
+        mHomeSet += "        </D:resourcetype>\n"
+                    "        <D:displayname>Collection " + number + "</D:displayname>\n"
+                    "        <D:current-user-privilege-set>\n"
+                    "          <D:privilege><D:read/></D:privilege>\n"
+                    "          <D:privilege><D:write/></D:privilege>\n"
+                    "        </D:current-user-privilege-set>\n"
+                    "        <CS:getctag>ctag-" + number + "</CS:getctag>\n"
+                    "      </D:prop>\n"
+                    "      <D:status>HTTP/1.1 200 OK</D:status>\n"
+                    "    </D:propstat>\n"
+                    "  </D:response>\n";
+    }
+
+    mHomeSet += "</D:multistatus>\n";
+}
+
+void DavCollectionsFilterBenchmark::nativeFilter()
+{
+    const KDAV2::DavProtocolBase *protocol = KDAV2::DavManager::self()->davProtocol(KDAV2::CalDav);
+
+    int count = 0;
+    QBENCHMARK {
+        count = 0;
+
+        KDAV2::DavMultistatusReader reader;
+        reader.addData(mHomeSet);
+        while (reader.readNextResponse()) {
+            if (protocol->isCollectionResponse(reader.response().element())) {
+                ++count;
+            }
+        }
+    }
+
+    QCOMPARE(count, calendarCount);
+}
+
+#ifdef HAVE_XMLPATTERNS
+// What DavCollectionsFetchJob used to do: parse the document, serialize it
+// again for the XQuery, then parse the result of the query.
+void DavCollectionsFilterBenchmark::xqueryFilter()
+{
+    const QString query(QStringLiteral("//*[local-name()='calendar' and namespace-uri()='urn:ietf:params:xml:ns:caldav']/ancestor::*[local-name()='prop' and namespace-uri()='DAV:']/ancestor::*[local-name()='response' and namespace-uri()='DAV:']"));
+
+    int count = 0;
+    QBENCHMARK {
+        count = 0;
+
+        QDomDocument multistatus;
+        multistatus.setContent(mHomeSet, true);
+
+        QByteArray resp(multistatus.toByteArray());
+        QBuffer buffer(&resp);
+        buffer.open(QIODevice::ReadOnly);
+
+        QXmlQuery xquery;
+        QVERIFY(xquery.setFocus(&buffer));
+        xquery.setQuery(query);
+        QVERIFY(xquery.isValid());
+
+        QString responsesStr;
+        xquery.evaluateTo(&responsesStr);
+        responsesStr.prepend(QStringLiteral("<responses>"));
+        responsesStr.append(QStringLiteral("</responses>"));
+
+        QDomDocument document;
+        QVERIFY(document.setContent(responsesStr, true));
+
+        QDomElement responseElement = document.documentElement().firstChildElement();
+        while (!responseElement.isNull()) {
+            ++count;
+            responseElement = responseElement.nextSiblingElement();
+        }
+    }
+
+    QCOMPARE(count, calendarCount);
+}
+#endif
+
+QTEST_GUILESS_MAIN(DavCollectionsFilterBenchmark)
@@ -0,0 +1,119 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include "davcollectionsmultifetchjobtest.h"
+#include "fakeserver.h"
+
+#include <KDAV2/DavCollectionsMultiFetchJob>
+#include <KDAV2/DavSession>
+#include <KDAV2/DavUrl>
+
+#include <QSignalSpy>
+#include <QTest>
+
+void DavCollectionsMultiFetchJobTest::runSharedCollectionTest()
+{
+    KDAV2::DavSession session;
+
+    FakeServer fakeServer;
+    QUrl firstUrl(QStringLiteral("http://localhost/dav/a/"));
+    firstUrl.setPort(fakeServer.port());
+    QUrl secondUrl(QStringLiteral("http://localhost/dav/b/"));
+    secondUrl.setPort(fakeServer.port());
+
+    // Both accounts see the same calendar, one url is fetched after the other
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsmultifetchjob1.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsmultifetchjob2.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsmultifetchjob3.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsmultifetchjob4.txt"));
+    fakeServer.startAndWait();
+
+    const KDAV2::DavUrl::List urls = { KDAV2::DavUrl(firstUrl, KDAV2::CalDav), KDAV2::DavUrl(secondUrl, KDAV2::CalDav) };
+    auto job = new KDAV2::DavCollectionsMultiFetchJob(urls);
+    job->setSession(&session);
+    job->setMaxConcurrentJobs(1);
+    job->setAutoDelete(false);
+    QSignalSpy spy(job, &KDAV2::DavCollectionsMultiFetchJob::collectionDiscovered);
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+    QCOMPARE(job->collections().size(), 1);
+    QCOMPARE(spy.count(), 1);
+    delete job;
+}
+
+void DavCollectionsMultiFetchJobTest::runDuplicateUrlTest()
+{
+    KDAV2::DavSession session;
+
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/dav/a/"));
+    url.setPort(fakeServer.port());
+    const QUrl otherSpelling = url.adjusted(QUrl::StripTrailingSlash);
+
+    // The same url given three times is fetched once
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsmultifetchjob1.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsmultifetchjob2.txt"));
+    fakeServer.startAndWait();
+
+    const KDAV2::DavUrl::List urls = { KDAV2::DavUrl(url, KDAV2::CalDav), KDAV2::DavUrl(url, KDAV2::CalDav), KDAV2::DavUrl(otherSpelling, KDAV2::CalDav) };
+    auto job = new KDAV2::DavCollectionsMultiFetchJob(urls);
+    job->setSession(&session);
+    job->setAutoDelete(false);
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+    QCOMPARE(job->collections().size(), 1);
+    delete job;
+}
+
+void DavCollectionsMultiFetchJobTest::runCombinedHomeSetsTest()
+{
+    KDAV2::DavSession session;
+
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/dav/"));
+    url.setPort(fakeServer.port());
+
+    // The home sets of both protocols are asked for in a single request,
+    // the CardDav url waits for it and then only lists its home set
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsmultifetchjob5.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsmultifetchjob6.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsmultifetchjob7.txt"));
+    fakeServer.startAndWait();
+
+    const KDAV2::DavUrl::List urls = { KDAV2::DavUrl(url, KDAV2::CalDav), KDAV2::DavUrl(url, KDAV2::CardDav) };
+    auto job = new KDAV2::DavCollectionsMultiFetchJob(urls);
+    job->setSession(&session);
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+
+    QUrl principalUrl(url);
+    principalUrl.setPath(QStringLiteral("/dav/principals/me/"));
+    QCOMPARE(session.principalUrl(url), principalUrl);
+    QCOMPARE(session.homeSets(principalUrl, KDAV2::CardDav), QStringList() << QStringLiteral("/dav/addressbooks/me/"));
+}
+
+QTEST_MAIN(DavCollectionsMultiFetchJobTest)
@@ -0,0 +1,123 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#include "davcollectionsyncjobtest.h"
+#include "fakeserver.h"
+
+#include <KDAV2/DavCollectionSyncJob>
+#include <KDAV2/DavError>
+#include <KDAV2/DavUrl>
+
+#include <QTest>
+
+void DavCollectionSyncJobTest::syncTruncated()
+{
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/calendar/"));
+    url.setPort(fakeServer.port());
+    KDAV2::DavUrl davUrl(url, KDAV2::CalDav);
+
+    auto job = new KDAV2::DavCollectionSyncJob(davUrl, QStringLiteral("http://example.com/sync/1"));
+
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsyncjob1.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsyncjob2.txt"));
+    fakeServer.startAndWait();
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+    QCOMPARE(job->syncToken(), QStringLiteral("http://example.com/sync/3"));
+    QVERIFY(!job->isTruncated());
+
+    // event2 has been removed, then created again
+    const auto changed = job->changedItems();
+    QCOMPARE(changed.size(), 2);
+    QCOMPARE(changed.at(0).url().url().path(), QStringLiteral("/calendar/event1.ics"));
+    QCOMPARE(changed.at(0).etag(), QStringLiteral("\"1\""));
+    QCOMPARE(changed.at(0).contentType(), QStringLiteral("text/calendar"));
+    QCOMPARE(changed.at(1).url().url().path(), QStringLiteral("/calendar/event2.ics"));
+    QCOMPARE(changed.at(1).etag(), QStringLiteral("\"2\""));
+
+    const auto removed = job->removedItems();
+    QCOMPARE(removed.size(), 1);
+    QCOMPARE(removed.at(0).url().path(), QStringLiteral("/calendar/event3.ics"));
+    QCOMPARE(removed.at(0).protocol(), KDAV2::CalDav);
+}
+
+void DavCollectionSyncJobTest::syncTruncatedStalled()
+{
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/calendar/"));
+    url.setPort(fakeServer.port());
+    KDAV2::DavUrl davUrl(url, KDAV2::CalDav);
+
+    auto job = new KDAV2::DavCollectionSyncJob(davUrl, QStringLiteral("http://example.com/sync/1"));
+
+    // The results are truncated, but the sync token stays the same
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datacollectionsyncjob3.txt"));
+    fakeServer.startAndWait();
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+    QVERIFY(job->isTruncated());
+    QCOMPARE(job->syncToken(), QStringLiteral("http://example.com/sync/1"));
+    QCOMPARE(job->changedItems().size(), 1);
+}
+
+void DavCollectionSyncJobTest::syncInvalidToken()
+{
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/calendar/"));
+    url.setPort(fakeServer.port());
+    KDAV2::DavUrl davUrl(url, KDAV2::CalDav);
+
+    auto job = new KDAV2::DavCollectionSyncJob(davUrl, QStringLiteral("http://example.com/sync/expired"));
+
+    QList<QByteArray> scenario;
+    scenario << "C: REPORT /calendar/ HTTP/1.1"
+             << "S: HTTP/1.0 403 Forbidden"
+             << "S: Content-Type: application/xml; charset=utf-8"
+             << "D: <?xml version=\"1.0\" encoding=\"utf-8\" ?>"
+             << "D: <d:error xmlns:d=\"DAV:\"><d:valid-sync-token/></d:error>"
+             << "X";
+    fakeServer.setScenario(scenario);
+    fakeServer.startAndWait();
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), static_cast<int>(KDAV2::ERR_COLLECTIONSYNC_INVALID_TOKEN));
+    QCOMPARE(job->latestHttpStatusCode(), 403u);
+}
+
+void DavCollectionSyncJobTest::syncNotSupported()
+{
+    QUrl url(QStringLiteral("http://localhost/calendar/"));
+    KDAV2::DavUrl davUrl(url, KDAV2::GroupDav);
+
+    auto job = new KDAV2::DavCollectionSyncJob(davUrl);
+    job->exec();
+
+    QCOMPARE(job->error(), static_cast<int>(KDAV2::ERR_COLLECTIONSYNC_NOT_SUPPORTED));
+}
+
+QTEST_GUILESS_MAIN(DavCollectionSyncJobTest)
@@ -0,0 +1,60 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include "davdiscoveryjobtest.h"
+#include "fakeserver.h"
+
+#include <KDAV2/DavDiscoveryJob>
+#include <KDAV2/DavSession>
+#include <KDAV2/DavUrl>
+
+#include <QTest>
+
+void DavDiscoveryJobTest::runRememberedPathTest()
+{
+    KDAV2::DavSession session;
+
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost"));
+    url.setPort(fakeServer.port());
+    QUrl wellKnownUrl(url);
+    wellKnownUrl.setPath(QStringLiteral("/.well-known/caldav"));
+
+    // Only the path that found the principal before is asked
+    session.setDiscoveryPath(wellKnownUrl, QStringLiteral("/dav/"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datadiscoveryjob1.txt"));
+    fakeServer.startAndWait();
+
+    auto job = new KDAV2::DavDiscoveryJob(KDAV2::DavUrl(url, KDAV2::CalDav), QStringLiteral("caldav"));
+    job->setSession(&session);
+    job->setParallelDiscovery(true);
+    job->setFallbackPaths(QStringList() << QStringLiteral("/dav/"));
+    job->setAutoDelete(false);
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+    QUrl principalUrl(url);
+    principalUrl.setPath(QStringLiteral("/dav/principals/me/"));
+    QCOMPARE(job->url(), principalUrl);
+    QCOMPARE(session.discoveryPath(wellKnownUrl), QStringLiteral("/dav/"));
+    delete job;
+}
+
+QTEST_MAIN(DavDiscoveryJobTest)
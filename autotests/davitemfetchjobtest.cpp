@@ -19,8 +19,12 @@
 #include "davitemfetchjobtest.h"
 #include "fakeserver.h"
 
+#include <KDAV2/DavItemDiskCache>
 #include <KDAV2/DavItemFetchJob>
+#include <KDAV2/DavSession>
 
+#include <QDir>
+#include <QTemporaryDir>
 #include <QTest>
 
 void DavItemFetchJobTest::runSuccessfullTest()
@@ -33,6 +37,7 @@ void DavItemFetchJobTest::runSuccessfullTest()
     KDAV2::DavItem item(davUrl, QString(), QByteArray(), QString());
 
     auto job = new KDAV2::DavItemFetchJob(item);
+    QCOMPARE(job->priority(), KDAV2::InteractivePriority);
 
     fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/dataitemfetchjob.txt"));
     fakeServer.startAndWait();
@@ -54,4 +59,49 @@ void DavItemFetchJobTest::runSuccessfullTest()
 
 }
 
+void DavItemFetchJobTest::runCachedTest()
+{
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    KDAV2::DavItemDiskCache cache(cacheDir.path());
+    KDAV2::DavSession session;
+    session.setItemCache(&cache);
+
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/item"));
+    url.setPort(fakeServer.port());
+    KDAV2::DavUrl davUrl(url, KDAV2::CardDav);
+
+    const KDAV2::DavItem item(davUrl, QString(), QByteArray(), QString());
+
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/dataitemfetchjob.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/dataitemfetchjob2.txt"));
+    fakeServer.startAndWait();
+
+    auto job = new KDAV2::DavItemFetchJob(item);
+    job->setSession(&session);
+    job->exec();
+    QCOMPARE(job->error(), 0);
+    QVERIFY(!job->isFromCache());
+    const KDAV2::DavItem fetchedItem = job->item();
+
+    // Only the user may read the cached item
+    const QFileInfoList files = QDir(cacheDir.path()).entryInfoList(QDir::Files);
+    QCOMPARE(files.size(), 1);
+    QCOMPARE(files.first().permissions() & (QFileDevice::ReadGroup | QFileDevice::ReadOther), QFileDevice::Permissions());
+
+    // The second fetch sends the cached etag and gets a 304 without a body
+    job = new KDAV2::DavItemFetchJob(item);
+    job->setSession(&session);
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+    QVERIFY(job->isFromCache());
+    QCOMPARE(job->item().data(), fetchedItem.data());
+    QCOMPARE(job->item().etag(), QStringLiteral("7a33141f192d904d-47"));
+    QCOMPARE(job->item().contentType(), QStringLiteral("text/x-vcard"));
+}
+
 QTEST_GUILESS_MAIN(DavItemFetchJobTest)
@@ -27,6 +27,7 @@ class DavItemFetchJobTest : public QObject
 
 private Q_SLOTS:
     void runSuccessfullTest();
+    void runCachedTest();
 };
 
 #endif
@@ -0,0 +1,72 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#include "davitemmodifyjobtest.h"
+#include "fakeserver.h"
+
+#include <KDAV2/DavItemModifyJob>
+#include <KDAV2/DavUrl>
+
+#include <QTest>
+
+static KDAV2::DavItem createItem(const FakeServer &fakeServer)
+{
+    QUrl url(QStringLiteral("http://localhost/item.vcf"));
+    url.setPort(fakeServer.port());
+    KDAV2::DavUrl davUrl(url, KDAV2::CardDav);
+
+    return KDAV2::DavItem(davUrl, QStringLiteral("text/vcard"),
+                          "BEGIN:VCARD\r\nVERSION:3.0\r\nFN:John Doe\r\nEND:VCARD\r\n",
+                          QStringLiteral("\"1\""));
+}
+
+void DavItemModifyJobTest::modifyWithStrongETag()
+{
+    FakeServer fakeServer;
+    auto job = new KDAV2::DavItemModifyJob(createItem(fakeServer));
+
+    // The etag of the PUT response is used as is, nothing is fetched afterwards
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/dataitemmodifyjob1.txt"));
+    fakeServer.startAndWait();
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+    QCOMPARE(job->item().etag(), QStringLiteral("\"2\""));
+}
+
+void DavItemModifyJobTest::modifyWithWeakETag()
+{
+    FakeServer fakeServer;
+    auto job = new KDAV2::DavItemModifyJob(createItem(fakeServer));
+
+    // A weak etag is not trusted, the etag alone is fetched with a PROPFIND
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/dataitemmodifyjob2.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/dataitemmodifyjob3.txt"));
+    fakeServer.startAndWait();
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+    QCOMPARE(job->item().etag(), QStringLiteral("\"3\""));
+}
+
+QTEST_GUILESS_MAIN(DavItemModifyJobTest)
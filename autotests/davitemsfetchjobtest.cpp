@@ -0,0 +1,72 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#include "davitemsfetchjobtest.h"
+#include "fakeserver.h"
+
+#include <KDAV2/DavItemsFetchJob>
+#include <KDAV2/DavUrl>
+
+#include <QTest>
+
+void DavItemsFetchJobTest::fetchInBatches()
+{
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/addressbook/"));
+    url.setPort(fakeServer.port());
+    KDAV2::DavUrl davUrl(url, KDAV2::CardDav);
+
+    const QStringList urls = {
+        QStringLiteral("/addressbook/a.vcf"),
+        QStringLiteral("/addressbook/b.vcf"),
+        QStringLiteral("/addressbook/c.vcf")
+    };
+
+    auto job = new KDAV2::DavItemsFetchJob(davUrl, urls);
+    job->setBatchSize(2);
+    job->setMaxConcurrentRequests(1);
+
+    QList<KDAV2::DavItem::List> batches;
+    connect(job, &KDAV2::DavItemsFetchJob::itemsReceived, this, [&batches] (const KDAV2::DavItem::List &items) {
+        batches << items;
+    });
+
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/dataitemsfetchjob1.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/dataitemsfetchjob2.txt"));
+    fakeServer.startAndWait();
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+
+    // b.vcf is reported as not found, c.vcf is missing from the response
+    QCOMPARE(job->failedUrls(), QStringList() << urls.at(1) << urls.at(2));
+
+    QCOMPARE(batches.size(), 1);
+    QCOMPARE(batches.at(0).size(), 1);
+
+    const auto items = job->items();
+    QCOMPARE(items.size(), 1);
+    QCOMPARE(items.at(0).url().url().path(), QStringLiteral("/addressbook/a.vcf"));
+    QCOMPARE(items.at(0).etag(), QStringLiteral("\"a1\""));
+    QCOMPARE(items.at(0).data(), QByteArray("BEGIN:VCARD\r\nVERSION:3.0\r\nFN:John Doe\r\nEND:VCARD\r\n"));
+}
+
+QTEST_GUILESS_MAIN(DavItemsFetchJobTest)
@@ -19,7 +19,9 @@
 #include "davitemslistjobtest.h"
 #include "fakeserver.h"
 
+#include <KDAV2/DavCollection>
 #include <KDAV2/DavItemsListJob>
+#include <KDAV2/DavSession>
 #include <KDAV2/DavUrl>
 
 #include <QTest>
@@ -38,4 +40,170 @@ void DavItemsListJobTest::noMatchingMimetype()
 
 }
 
+void DavItemsListJobTest::combinedListing_data()
+{
+    QTest::addColumn<bool>("backgroundParsing");
+
+    QTest::newRow("background parsing") << true;
+    QTest::newRow("parsing in the job thread") << false;
+}
+
+void DavItemsListJobTest::combinedListing()
+{
+    QFETCH(bool, backgroundParsing);
+
+    KDAV2::DavSession session;
+    session.setBackgroundParsing(backgroundParsing);
+
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/calendar/"));
+    url.setPort(fakeServer.port());
+    KDAV2::DavUrl davUrl(url, KDAV2::CalDav);
+
+    auto job = new KDAV2::DavItemsListJob(davUrl);
+    job->setSession(&session);
+
+    // All the components are listed with a single request
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/dataitemslistjob1.txt"));
+    fakeServer.startAndWait();
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+
+    const auto items = job->items();
+    QCOMPARE(items.size(), 2);
+    QCOMPARE(items.at(0).url().url().path(), QStringLiteral("/calendar/event.ics"));
+    QCOMPARE(items.at(0).contentType(), QStringLiteral("VEVENT"));
+    QCOMPARE(items.at(0).etag(), QStringLiteral("\"e1\""));
+    QCOMPARE(items.at(1).url().url().path(), QStringLiteral("/calendar/todo.ics"));
+    QCOMPARE(items.at(1).contentType(), QStringLiteral("VTODO"));
+}
+
+void DavItemsListJobTest::combinedListingFallback_data()
+{
+    QTest::addColumn<QString>("rejection");
+
+    QTest::newRow("bad request") << QStringLiteral("/dataitemslistjob2.txt");
+    QTest::newRow("filter precondition") << QStringLiteral("/dataitemslistjob4.txt");
+}
+
+void DavItemsListJobTest::combinedListingFallback()
+{
+    QFETCH(QString, rejection);
+
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/calendar/"));
+    url.setPort(fakeServer.port());
+    KDAV2::DavUrl davUrl(url, KDAV2::CalDav);
+
+    auto job = new KDAV2::DavItemsListJob(davUrl);
+
+    // The combined request is rejected, one request per component follows
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+rejection);
+    for (int i = 0; i < 3; ++i) {
+        fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/dataitemslistjob3.txt"));
+    }
+    fakeServer.startAndWait();
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+    QVERIFY(job->items().isEmpty());
+}
+
+void DavItemsListJobTest::combinedListingForbidden()
+{
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/calendar/"));
+    url.setPort(fakeServer.port());
+    KDAV2::DavUrl davUrl(url, KDAV2::CalDav);
+
+    auto job = new KDAV2::DavItemsListJob(davUrl);
+
+    // A plain 403 is about access, the requests per component would fail the same
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/dataitemslistjob5.txt"));
+    fakeServer.startAndWait();
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QVERIFY(job->error() != 0);
+    QCOMPARE(job->latestHttpStatusCode(), 403u);
+}
+
+void DavItemsListJobTest::discoveredItems()
+{
+    KDAV2::DavSession session;
+
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/calendar/"));
+    url.setPort(fakeServer.port());
+    KDAV2::DavUrl davUrl(url, KDAV2::CalDav);
+
+    auto job = new KDAV2::DavItemsListJob(davUrl);
+    job->setSession(&session);
+    job->setKeepItems(false);
+    job->setAutoDelete(false);
+    int batches = 0;
+    KDAV2::DavItem::List discovered;
+    connect(job, &KDAV2::DavItemsListJob::itemsDiscovered, [&] (const KDAV2::DavItem::List &items) {
+        QVERIFY(!items.isEmpty());
+        ++batches;
+        discovered << items;
+    });
+
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/dataitemslistjob1.txt"));
+    fakeServer.startAndWait();
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+
+    // The items are announced, but not kept
+    QVERIFY(batches >= 1);
+    QCOMPARE(discovered.size(), 2);
+    QCOMPARE(discovered.at(0).url().url().path(), QStringLiteral("/calendar/event.ics"));
+    QCOMPARE(discovered.at(0).etag(), QStringLiteral("\"e1\""));
+    QCOMPARE(discovered.at(1).url().url().path(), QStringLiteral("/calendar/todo.ics"));
+    QCOMPARE(discovered.at(1).etag(), QStringLiteral("\"t1\""));
+    QVERIFY(job->items().isEmpty());
+    delete job;
+}
+
+void DavItemsListJobTest::collectionContentTypes()
+{
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/calendar/"));
+    url.setPort(fakeServer.port());
+    KDAV2::DavUrl davUrl(url, KDAV2::CalDav);
+
+    // A task list only gets the VTODO query, a calendar that takes any
+    // component gets the combined query
+    auto job = new KDAV2::DavItemsListJob(KDAV2::DavCollection(davUrl, QStringLiteral("Tasks"), KDAV2::DavCollection::Todos));
+
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/dataitemslistjob3.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/dataitemslistjob3.txt"));
+    fakeServer.startAndWait();
+    job->exec();
+    QCOMPARE(job->error(), 0);
+
+    job = new KDAV2::DavItemsListJob(KDAV2::DavCollection(davUrl, QStringLiteral("Calendar"), KDAV2::DavCollection::Calendar));
+    job->exec();
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+
+    // Nothing can be listed in a free/busy only collection, no request is sent
+    job = new KDAV2::DavItemsListJob(KDAV2::DavCollection(davUrl, QStringLiteral("Busy"), KDAV2::DavCollection::FreeBusy));
+    job->exec();
+
+    QCOMPARE(job->error(), 0);
+    QVERIFY(job->items().isEmpty());
+}
+
 QTEST_GUILESS_MAIN(DavItemsListJobTest)
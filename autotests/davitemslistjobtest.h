@@ -27,6 +27,13 @@ class DavItemsListJobTest : public QObject
 
 private Q_SLOTS:
     void noMatchingMimetype();
+    void combinedListing_data();
+    void combinedListing();
+    void combinedListingFallback_data();
+    void combinedListingFallback();
+    void combinedListingForbidden();
+    void discoveredItems();
+    void collectionContentTypes();
 };
 
 #endif
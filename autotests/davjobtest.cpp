@@ -0,0 +1,266 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include "davjobtest.h"
+#include "fakeserver.h"
+
+#include <KDAV2/DavItemFetchJob>
+#include <KDAV2/DavJob>
+#include <KDAV2/DavMultistatusReader>
+#include <KDAV2/DavRetryPolicy>
+#include <KDAV2/DavSession>
+
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTest>
+
+void DavJobTest::parseRetryAfter()
+{
+    const QDateTime now(QDate(2017, 1, 4), QTime(18, 26, 46), Qt::UTC);
+    QCOMPARE(KDAV2::DavRetryPolicy::parseRetryAfter("120", now), qint64(120000));
+    QCOMPARE(KDAV2::DavRetryPolicy::parseRetryAfter("Wed, 04 Jan 2017 18:27:16 GMT", now), qint64(30000));
+    QCOMPARE(KDAV2::DavRetryPolicy::parseRetryAfter("soon", now), qint64(-1));
+}
+
+void DavJobTest::retryTransientFailure()
+{
+    KDAV2::DavSession session;
+
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/item"));
+    url.setPort(fakeServer.port());
+
+    // The first attempt is shed with a 503, the retry succeeds
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datajobretry1.txt"));
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datajobretry2.txt"));
+    fakeServer.startAndWait();
+
+    auto job = session.createGetJob(url);
+    job->setAutoDelete(false);
+    QSignalSpy spy(job, &KJob::result);
+    QTRY_COMPARE(spy.count(), 1);
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QCOMPARE(job->error(), 0);
+    QCOMPARE(job->retryCount(), 1);
+    QCOMPARE(job->httpStatusCode(), 200);
+    QCOMPARE(job->getETagHeader(), QStringLiteral("7a33141f192d904d-47"));
+    delete job;
+}
+
+void DavJobTest::retryAfterBeyondMaxDelay()
+{
+    KDAV2::DavRetryPolicy policy;
+    policy.setMaxDelay(30000);
+    KDAV2::DavSession session;
+    session.setRetryPolicy(policy);
+
+    FakeServer fakeServer;
+    QUrl url(QStringLiteral("http://localhost/item"));
+    url.setPort(fakeServer.port());
+
+    // The server asks to come back in two minutes, longer than we are willing to wait
+    fakeServer.addScenarioFromFile(QLatin1String(AUTOTEST_DATA_DIR)+QStringLiteral("/datajobretry3.txt"));
+    fakeServer.startAndWait();
+
+    auto job = session.createGetJob(url);
+    job->setAutoDelete(false);
+    QSignalSpy spy(job, &KJob::result);
+    QTRY_COMPARE(spy.count(), 1);
+    fakeServer.quit();
+
+    QVERIFY(fakeServer.isAllScenarioDone());
+    QVERIFY(job->error() != 0);
+    QCOMPARE(job->retryCount(), 0);
+    QCOMPARE(job->httpStatusCode(), 503);
+    delete job;
+}
+
+void DavJobTest::retryResetWhileParsing()
+{
+    QByteArray body = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<d:multistatus xmlns:d=\"DAV:\">\n";
+    for (int i = 0; i < 200; ++i) {
+        body += QStringLiteral("<d:response><d:href>/items/%1.ics</d:href><d:propstat><d:prop>"
+                               "<d:getetag>\"%1\"</d:getetag></d:prop><d:status>HTTP/1.1 200 OK</d:status>"
+                               "</d:propstat></d:response>\n").arg(i).toUtf8();
+    }
+    body += "</d:multistatus>\n";
+    const QByteArray header = "HTTP/1.1 207 Multi-Status\r\n"
+                              "Content-Type: application/xml; charset=utf-8\r\n"
+                              "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                              "Connection: close\r\n\r\n";
+
+    // Whether the reset is noticed before the first responses are handed
+    // out depends on the thread pool, try a few times
+    for (int attempt = 0; attempt < 10; ++attempt) {
+        // Resets the first connection in the middle of the multistatus
+        QTcpServer server;
+        QVERIFY(server.listen(QHostAddress::LocalHost));
+        int connections = 0;
+        connect(&server, &QTcpServer::newConnection, [&] () {
+            QTcpSocket *socket = server.nextPendingConnection();
+            const bool reset = connections++ == 0;
+            connect(socket, &QTcpSocket::readyRead, socket, [socket, reset, header, body] () {
+                const QByteArray request = socket->property("request").toByteArray() + socket->readAll();
+                socket->setProperty("request", request);
+                if (!request.contains("\r\n\r\n")) {
+                    return;
+                }
+                if (reset) {
+                    socket->write(header + body.left(body.size() / 2));
+                    socket->waitForBytesWritten();
+                    socket->abort();
+                } else {
+                    socket->write(header + body);
+                    socket->disconnectFromHost();
+                }
+            });
+        });
+        QUrl url(QStringLiteral("http://localhost/items/"));
+        url.setPort(server.serverPort());
+
+        KDAV2::DavRetryPolicy policy;
+        policy.setMaxRetries(1);
+        policy.setInitialDelay(0);
+        policy.setJitter(0);
+        KDAV2::DavSession session;
+        session.setRetryPolicy(policy);
+        session.setBackgroundParsing(true);
+
+        auto job = session.createGetJob(url);
+        job->setStreaming(true);
+        job->setAutoDelete(false);
+        QStringList hrefs;
+        connect(job, &KDAV2::DavJob::responseParsed, [&hrefs] (const KDAV2::DavMultistatusResponse &response) {
+            hrefs << response.href();
+        });
+        QSignalSpy spy(job, &KJob::result);
+        QTRY_COMPARE(spy.count(), 1);
+
+        // Nothing is handed out twice, whether the request was retried or not
+        QCOMPARE(hrefs.toSet().size(), hrefs.size());
+        if (job->error() == 0) {
+            QCOMPARE(job->retryCount(), 1);
+            QCOMPARE(hrefs.size(), 200);
+        } else {
+            QCOMPARE(job->retryCount(), 0);
+            QVERIFY(hrefs.size() < 200);
+        }
+        delete job;
+    }
+}
+
+void DavJobTest::killWhileStreaming()
+{
+    const QByteArray body = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<d:multistatus xmlns:d=\"DAV:\">\n"
+                            "<d:response><d:href>/items/1.ics</d:href><d:status>HTTP/1.1 200 OK</d:status></d:response>\n"
+                            "<d:response><d:href>/items/2.ics</d:href><d:status>HTTP/1.1 200 OK</d:status></d:response>\n"
+                            "</d:multistatus>\n";
+    const QByteArray response = "HTTP/1.1 207 Multi-Status\r\n"
+                                "Content-Type: application/xml; charset=utf-8\r\n"
+                                "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                                "Connection: close\r\n\r\n" + body;
+
+    QTcpServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    connect(&server, &QTcpServer::newConnection, [&] () {
+        QTcpSocket *socket = server.nextPendingConnection();
+        connect(socket, &QTcpSocket::readyRead, socket, [socket, response] () {
+            const QByteArray request = socket->property("request").toByteArray() + socket->readAll();
+            socket->setProperty("request", request);
+            if (request.contains("\r\n\r\n")) {
+                socket->write(response);
+                socket->disconnectFromHost();
+            }
+        });
+    });
+    QUrl url(QStringLiteral("http://localhost/items/"));
+    url.setPort(server.serverPort());
+
+    KDAV2::DavSession session;
+    auto job = session.createGetJob(url);
+    job->setStreaming(true);
+    job->setAutoDelete(false);
+
+    // The first response is enough, nothing else comes afterwards
+    QStringList hrefs;
+    connect(job, &KDAV2::DavJob::responseParsed, [&hrefs, job] (const KDAV2::DavMultistatusResponse &response) {
+        hrefs << response.href();
+        job->kill(KJob::Quietly);
+    });
+    QSignalSpy finishedSpy(job, &KJob::finished);
+    QSignalSpy resultSpy(job, &KJob::result);
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QTest::qWait(100);
+
+    QCOMPARE(resultSpy.count(), 0);
+    QCOMPARE(hrefs, QStringList() << QStringLiteral("/items/1.ics"));
+    QCOMPARE(job->error(), int(KJob::KilledJobError));
+    delete job;
+}
+
+void DavJobTest::requestTimeout()
+{
+    KDAV2::DavSession session;
+
+    // A server that accepts the connection but never answers
+    QTcpServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    QUrl url(QStringLiteral("http://localhost/item"));
+    url.setPort(server.serverPort());
+
+    auto job = session.createGetJob(url);
+    job->setTimeout(200);
+    job->setAutoDelete(false);
+    QSignalSpy spy(job, &KJob::result);
+
+    QTRY_COMPARE(spy.count(), 1);
+    QVERIFY(job->error() != 0);
+    QCOMPARE(job->responseCode(), QNetworkReply::TimeoutError);
+    QTRY_COMPARE(session.runningRequestCount(), 0);
+    delete job;
+}
+
+void DavJobTest::jobTimeout()
+{
+    KDAV2::DavSession session;
+
+    // A server that accepts the connection but never answers
+    QTcpServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    QUrl url(QStringLiteral("http://localhost/item"));
+    url.setPort(server.serverPort());
+
+    auto job = new KDAV2::DavItemFetchJob(KDAV2::DavItem(KDAV2::DavUrl(url, KDAV2::CardDav), QString(), QByteArray(), QString()));
+    job->setSession(&session);
+    job->setTimeout(200);
+    job->setAutoDelete(false);
+    QSignalSpy spy(job, &KJob::result);
+    job->start();
+
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(job->error(), static_cast<int>(KDAV2::ERR_TIMEOUT));
+    QVERIFY(job->canRetryLater());
+    // The aborted request no longer holds a slot of the scheduler
+    QTRY_COMPARE(session.runningRequestCount(), 0);
+    delete job;
+}
+
+QTEST_GUILESS_MAIN(DavJobTest)
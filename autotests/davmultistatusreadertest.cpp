@@ -0,0 +1,150 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include "davmultistatusreadertest.h"
+
+#include <KDAV2/DavMultistatusReader>
+
+#include <QTest>
+
+static const QByteArray multistatus(
+    "<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n"
+    "<D:multistatus xmlns:D=\"DAV:\" xmlns:C=\"urn:ietf:params:xml:ns:caldav\">\n"
+    "  <D:response>\n"
+    "    <D:href>/calendars/test/event1.ics</D:href>\n"
+    "    <D:propstat>\n"
+    "      <D:prop>\n"
+    "        <D:getetag>\"b4bbea0278f4f63854c4167a7656024a\"</D:getetag>\n"
+    "        <C:calendar-data>BEGIN:VCALENDAR\r\nVERSION:2.0\r\nEND:VCALENDAR\r\n</C:calendar-data>\n"
+    "      </D:prop>\n"
+    "      <D:status>HTTP/1.1 200 OK</D:status>\n"
+    "    </D:propstat>\n"
+    "    <D:propstat>\n"
+    "      <D:prop>\n"
+    "        <D:displayname/>\n"
+    "      </D:prop>\n"
+    "      <D:status>HTTP/1.1 404 Not Found</D:status>\n"
+    "    </D:propstat>\n"
+    "  </D:response>\n"
+    "  <D:response>\n"
+    "    <D:href>/calendars/test/event2.ics</D:href>\n"
+    "    <D:status>HTTP/1.1 404 Not Found</D:status>\n"
+    "  </D:response>\n"
+    "  <D:response>\n"
+    "    <D:href>/calendars/test/</D:href>\n"
+    "    <D:propstat>\n"
+    "      <D:prop>\n"
+    "        <C:supported-calendar-component-set>\n"
+    "          <C:comp name=\"VEVENT\"/>\n"
+    "        </C:supported-calendar-component-set>\n"
+    "      </D:prop>\n"
+    "      <D:status>HTTP/1.1 200 OK</D:status>\n"
+    "    </D:propstat>\n"
+    "  </D:response>\n"
+    "</D:multistatus>\n");
+
+static QList<KDAV2::DavMultistatusResponse> readAll(KDAV2::DavMultistatusReader &reader, const QByteArray &data, int chunkSize)
+{
+    QList<KDAV2::DavMultistatusResponse> responses;
+    for (int i = 0; i < data.size(); i += chunkSize) {
+        reader.addData(data.mid(i, chunkSize));
+        while (reader.readNextResponse()) {
+            responses << reader.response();
+        }
+    }
+    return responses;
+}
+
+static void verifyResponses(const QList<KDAV2::DavMultistatusResponse> &responses)
+{
+    QCOMPARE(responses.size(), 3);
+
+    const auto first = responses.at(0);
+    QCOMPARE(first.href(), QStringLiteral("/calendars/test/event1.ics"));
+    QCOMPARE(first.status(), QString());
+    QCOMPARE(first.propstats().size(), 2);
+
+    const QDomElement prop = first.successfulProp();
+    QVERIFY(!prop.isNull());
+    QCOMPARE(prop.firstChildElement(QStringLiteral("getetag")).text(), QStringLiteral("\"b4bbea0278f4f63854c4167a7656024a\""));
+    const QDomElement dataElement = prop.elementsByTagNameNS(QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("calendar-data")).item(0).toElement();
+    QCOMPARE(dataElement.firstChild().toText().data(), QStringLiteral("BEGIN:VCALENDAR\r\nVERSION:2.0\r\nEND:VCALENDAR\r\n"));
+
+    const auto second = responses.at(1);
+    QCOMPARE(second.href(), QStringLiteral("/calendars/test/event2.ics"));
+    QCOMPARE(second.status(), QStringLiteral("HTTP/1.1 404 Not Found"));
+    QVERIFY(second.successfulPropstat().isNull());
+
+    const auto third = responses.at(2);
+    QCOMPARE(third.href(), QStringLiteral("/calendars/test/"));
+    const QDomElement compElement = third.successfulProp().elementsByTagNameNS(QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("comp")).item(0).toElement();
+    QCOMPARE(compElement.attribute(QStringLiteral("name")), QStringLiteral("VEVENT"));
+}
+
+void DavMultistatusReaderTest::readWholeDocument()
+{
+    KDAV2::DavMultistatusReader reader;
+    const auto responses = readAll(reader, multistatus, multistatus.size());
+
+    QVERIFY(reader.isMultistatus());
+    QVERIFY(reader.atEnd());
+    QVERIFY(!reader.hasError());
+    verifyResponses(responses);
+}
+
+void DavMultistatusReaderTest::readChunked()
+{
+    // Feed the document byte by byte, so that every element and text is split
+    KDAV2::DavMultistatusReader reader;
+    const auto responses = readAll(reader, multistatus, 1);
+
+    QVERIFY(reader.isMultistatus());
+    QVERIFY(reader.atEnd());
+    QVERIFY(!reader.hasError());
+    verifyResponses(responses);
+}
+
+void DavMultistatusReaderTest::readNoMultistatus()
+{
+    const QByteArray data("<?xml version=\"1.0\"?><D:error xmlns:D=\"DAV:\"><D:response><D:href>/</D:href></D:response></D:error>");
+
+    KDAV2::DavMultistatusReader reader;
+    const auto responses = readAll(reader, data, 7);
+
+    QVERIFY(!reader.isMultistatus());
+    QVERIFY(reader.atEnd());
+    QVERIFY(responses.isEmpty());
+}
+
+void DavMultistatusReaderTest::readBrokenDocument()
+{
+    const QByteArray data("<D:multistatus xmlns:D=\"DAV:\"><D:response><D:href>/</D:href></D:response><D:response></D:multistatus>");
+
+    KDAV2::DavMultistatusReader reader;
+    const auto responses = readAll(reader, data, data.size());
+
+    QCOMPARE(responses.size(), 1);
+    QVERIFY(reader.hasError());
+    QVERIFY(!reader.atEnd());
+
+    reader.clear();
+    QVERIFY(!reader.hasError());
+    QCOMPARE(readAll(reader, multistatus, 64).size(), 3);
+}
+
+QTEST_GUILESS_MAIN(DavMultistatusReaderTest)
@@ -0,0 +1,112 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#include "davvaluecopybenchmark.h"
+
+#include <KDAV2/DavUrl>
+
+#include <QTest>
+
+// Number of values in each of the lists that get copied
+static const int valueCount = 100000;
+
+// Copies every element on its own, as appending to another list does
+template<typename T>
+static QVector<T> copyElements(const QVector<T> &values)
+{
+    QVector<T> result;
+    result.reserve(values.size());
+    for (const T &value : values) {
+        result << value;
+    }
+    return result;
+}
+
+void DavValueCopyBenchmark::initTestCase()
+{
+    const QByteArray data = "BEGIN:VCALENDAR\nBEGIN:VEVENT\nSUMMARY:Benchmark\nEND:VEVENT\nEND:VCALENDAR\n";
+
+    mItems.reserve(valueCount);
+    mCollections.reserve(valueCount);
+    mUrls.reserve(valueCount);
+
+    for (int i = 0; i < valueCount; ++i) {
+        const QString number = QString::number(i);
+        const KDAV2::DavUrl url(QUrl(QStringLiteral("https://dav.example.com/calendars/test/") + number), KDAV2::CalDav);
+
+        mUrls << url;
+        mItems << KDAV2::DavItem(url, QStringLiteral("text/calendar"), data, QStringLiteral("\"etag-") + number + QStringLiteral("\""));
+        mCollections << KDAV2::DavCollection(url, QStringLiteral("Calendar ") + number, KDAV2::DavCollection::Events);
+    }
+}
+
+void DavValueCopyBenchmark::copyOnWrite()
+{
+    const KDAV2::DavUrl url(QUrl(QStringLiteral("https://dav.example.com/item.ics")), KDAV2::CalDav);
+    const KDAV2::DavItem item(url, QStringLiteral("text/calendar"), "data", QStringLiteral("etag"));
+
+    KDAV2::DavItem copy(item);
+    copy.setEtag(QStringLiteral("changed"));
+    copy.setData("changed");
+    QCOMPARE(item.etag(), QStringLiteral("etag"));
+    QCOMPARE(item.data(), QByteArray("data"));
+    QCOMPARE(copy.etag(), QStringLiteral("changed"));
+
+    KDAV2::DavUrl urlCopy(url);
+    urlCopy.setProtocol(KDAV2::CardDav);
+    QCOMPARE(url.protocol(), KDAV2::CalDav);
+    QCOMPARE(urlCopy.protocol(), KDAV2::CardDav);
+
+    const KDAV2::DavCollection collection(url, QStringLiteral("Calendar"), KDAV2::DavCollection::Events);
+    KDAV2::DavCollection collectionCopy = collection;
+    collectionCopy.setDisplayName(QStringLiteral("Changed"));
+    QCOMPARE(collection.displayName(), QStringLiteral("Calendar"));
+    QCOMPARE(collectionCopy.displayName(), QStringLiteral("Changed"));
+
+    KDAV2::DavItem moved(std::move(copy));
+    QCOMPARE(moved.etag(), QStringLiteral("changed"));
+    copy = item;
+    QCOMPARE(copy.etag(), QStringLiteral("etag"));
+}
+
+void DavValueCopyBenchmark::copyItemList()
+{
+    QBENCHMARK {
+        const KDAV2::DavItem::List copy = copyElements(mItems);
+        QCOMPARE(copy.size(), valueCount);
+    }
+}
+
+void DavValueCopyBenchmark::copyCollectionList()
+{
+    QBENCHMARK {
+        const KDAV2::DavCollection::List copy = copyElements(mCollections);
+        QCOMPARE(copy.size(), valueCount);
+    }
+}
+
+void DavValueCopyBenchmark::copyUrlList()
+{
+    QBENCHMARK {
+        const KDAV2::DavUrl::List copy = copyElements(mUrls);
+        QCOMPARE(copy.size(), valueCount);
+    }
+}
+
+QTEST_GUILESS_MAIN(DavValueCopyBenchmark)
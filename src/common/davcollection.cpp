@@ -24,14 +24,9 @@
 
 using namespace KDAV2;
 
-class DavCollectionPrivate
+class DavCollectionPrivate : public QSharedData
 {
 public:
-    DavCollectionPrivate(DavCollection *qPtr) : q(qPtr) {}
-
-    void fillFrom(const DavCollectionPrivate &other);
-
-    DavCollection *q;
     QString mCTag;
     DavUrl mUrl;
     QString mDisplayName;
@@ -40,24 +35,13 @@ public:
     Privileges mPrivileges;
 };
 
-void DavCollectionPrivate::fillFrom(const DavCollectionPrivate &other)
-{
-    mCTag = other.mCTag;
-    mUrl = other.mUrl;
-    mDisplayName = other.mDisplayName;
-    mColor = other.mColor;
-    mContentTypes = other.mContentTypes;
-    mPrivileges = other.mPrivileges;
-}
-
-
 DavCollection::DavCollection()
-    : d(std::unique_ptr<DavCollectionPrivate>(new DavCollectionPrivate(this)))
+    : d(new DavCollectionPrivate)
 {
 }
 
 DavCollection::DavCollection(const DavUrl &url, const QString &displayName, ContentTypes contentTypes)
-    : d(std::unique_ptr<DavCollectionPrivate>(new DavCollectionPrivate(this)))
+    : d(new DavCollectionPrivate)
 {
     d->mUrl = url;
     d->mDisplayName = displayName;
@@ -65,21 +49,15 @@ DavCollection::DavCollection(const DavUrl &url, const QString &displayName, Cont
     d->mPrivileges = KDAV2::All;
 }
 
-DavCollection::DavCollection(const DavCollection &other)
-    : d(std::unique_ptr<DavCollectionPrivate>(new DavCollectionPrivate(this)))
-{
-    d->fillFrom(*other.d.get());
-}
+DavCollection::DavCollection(const DavCollection &other) = default;
 
-DavCollection &DavCollection::operator=(const DavCollection &other)
-{
-    d->fillFrom(*other.d.get());
-    return *this;
-}
+DavCollection::DavCollection(DavCollection &&other) noexcept = default;
 
-DavCollection::~DavCollection()
-{
-}
+DavCollection &DavCollection::operator=(const DavCollection &other) = default;
+
+DavCollection &DavCollection::operator=(DavCollection &&other) noexcept = default;
+
+DavCollection::~DavCollection() = default;
 
 void DavCollection::setCTag(const QString &ctag)
 {
@@ -23,9 +23,9 @@
 
 #include "enums.h"
 
-#include <memory>
 
 #include <QtCore/QVector>
+#include <QtCore/QSharedDataPointer>
 #include <QtCore/QString>
 
 class QColor;
@@ -81,8 +81,15 @@ public:
      */
     DavCollection(const DavUrl &url, const QString &displayName, ContentTypes contentTypes);
 
+    /**
+     * Creates a shallow copy of @p other.
+     *
+     * The data is implicitly shared and only detached on the first write.
+     */
     DavCollection(const DavCollection &other);
+    DavCollection(DavCollection &&other) noexcept;
     DavCollection &operator=(const DavCollection &other);
+    DavCollection &operator=(DavCollection &&other) noexcept;
 
     ~DavCollection();
 
@@ -149,7 +156,7 @@ public:
     Privileges privileges() const;
 
 private:
-    std::unique_ptr<DavCollectionPrivate> d;
+    QSharedDataPointer<DavCollectionPrivate> d;
 };
 
 }
@@ -23,7 +23,7 @@
 #include "davcollectionmodifyjob.h"
 #include "daverror.h"
 #include "davjob.h"
-#include "davmanager.h"
+#include "davsession.h"
 
 #include <QColor>
 #include <QMetaEnum>
@@ -31,10 +31,15 @@
 using namespace KDAV2;
 
 DavCollectionCreateJob::DavCollectionCreateJob(const DavCollection &collection, QObject *parent)
-    : DavJobBase(parent), mCollection(collection), mRedirectCount(0)
+    : DavJobBase(parent), mCollection(collection), mRedirectCount(0), mFetchAfterCreation(false)
 {
 }
 
+void DavCollectionCreateJob::setFetchAfterCreation(bool fetch)
+{
+    mFetchAfterCreation = fetch;
+}
+
 void DavCollectionCreateJob::start()
 {
     auto protocol = mCollection.url().protocol();
@@ -49,7 +54,8 @@ void DavCollectionCreateJob::start()
             break;
         default: {
             // This is a normal collection
-            auto job = DavManager::self()->createMkColJob(collectionUrl());
+            auto job = session()->createMkColJob(collectionUrl());
+            prepareJob(job);
             connect(job, &DavJob::result, this, &DavCollectionCreateJob::collectionCreated);
         }
     }
@@ -75,8 +81,33 @@ void DavCollectionCreateJob::collectionCreated(KJob *job)
         return;
     }
 
-    DavCollectionModifyJob *modifyJob =
-        new DavCollectionModifyJob(DavUrl(storedJob->url(), mCollection.url().protocol()), this);
+    // The request might have been redirected, keep the credentials though
+    QUrl url = storedJob->url();
+    url.setUserInfo(collectionUrl().userInfo());
+    mCollection.setUrl(DavUrl(url, mCollection.url().protocol()));
+
+    const Protocol protocol = mCollection.url().protocol();
+    if (protocol == CalDav || protocol == CardDav) {
+        // All the properties were part of the request already
+        if (protocol == CardDav && !mCollection.contentTypes()) {
+            mCollection.setContentTypes(DavCollection::Contacts);
+        }
+
+        if (mFetchAfterCreation) {
+            fetchCollection();
+        } else {
+            emitResult();
+        }
+        return;
+    }
+
+    if (mCollection.displayName().isEmpty()) {
+        fetchCollection();
+        return;
+    }
+
+    DavCollectionModifyJob *modifyJob = new DavCollectionModifyJob(mCollection.url(), this);
+    prepareJob(modifyJob);
 
     modifyJob->setProperty(QStringLiteral("displayname"), mCollection.displayName());
 
@@ -93,7 +124,13 @@ void DavCollectionCreateJob::collectionModified(KJob *job)
         return;
     }
 
+    fetchCollection();
+}
+
+void DavCollectionCreateJob::fetchCollection()
+{
     DavCollectionFetchJob *fetchJob = new DavCollectionFetchJob(mCollection, this);
+    prepareJob(fetchJob);
     connect(fetchJob, &DavCollectionFetchJob::result, this, &DavCollectionCreateJob::collectionRefreshed);
     fetchJob->start();
 }
@@ -136,7 +173,7 @@ void DavCollectionCreateJob::createCalendar()
 
     QDomDocument document;
 
-    auto mkcalElement = document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("mkcalendar"));
+    auto mkcalElement = document.createElementNS(QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("mkcalendar"));
     document.appendChild(mkcalElement);
     auto setElement = mkcalElement.appendChild(
         document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("set")));
@@ -188,9 +225,9 @@ void DavCollectionCreateJob::createCalendar()
         compSetElement.appendChild(compElement);
     }
 
-    auto job = DavManager::self()->createMkCalendarJob(collectionUrl(), document);
-    // Skip the modification
-    connect(job, &DavJob::result, this, &DavCollectionCreateJob::collectionModified);
+    auto job = session()->createMkCalendarJob(collectionUrl(), document);
+    prepareJob(job);
+    connect(job, &DavJob::result, this, &DavCollectionCreateJob::collectionCreated);
 }
 
 void DavCollectionCreateJob::createAddressbook()
@@ -236,7 +273,7 @@ void DavCollectionCreateJob::createAddressbook()
         displayNameElement.appendChild(document.createTextNode(mCollection.displayName()));
     }
 
-    auto job = DavManager::self()->createMkColJob(collectionUrl(), document);
-    // Skip the modification
-    connect(job, &DavJob::result, this, &DavCollectionCreateJob::collectionModified);
+    auto job = session()->createMkColJob(collectionUrl(), document);
+    prepareJob(job);
+    connect(job, &DavJob::result, this, &DavCollectionCreateJob::collectionCreated);
 }
@@ -31,6 +31,11 @@ namespace KDAV2
 
 /**
  * @short A job that creates a DAV collection.
+ *
+ * CalDAV and CardDAV collections are created with a single MKCALENDAR or
+ * extended MKCOL request that carries all their properties. Other collections
+ * need a PROPPATCH for their display name and are fetched afterwards, as the
+ * server decides about their content types.
  */
 class KPIMKDAV2_EXPORT DavCollectionCreateJob : public DavJobBase
 {
@@ -51,8 +56,17 @@ public:
     void start() Q_DECL_OVERRIDE;
 
     /**
-     * Returns the created DAV item including the correct identifier url
-     * and current etag information.
+     * Sets whether the collection is fetched from the server once it has
+     * been created, to learn the properties only the server knows about,
+     * like its CTag and the privileges of the user.
+     *
+     * Disabled by default, in which case the returned collection is made of
+     * the created url and the properties that were sent to the server.
+     */
+    void setFetchAfterCreation(bool fetch);
+
+    /**
+     * Returns the created DAV collection including the correct identifier url.
      */
     DavCollection collection() const;
 
@@ -66,9 +80,11 @@ private Q_SLOTS:
 private:
     DavCollection mCollection;
     int mRedirectCount;
+    bool mFetchAfterCreation;
 
     void createCalendar();
     void createAddressbook();
+    void fetchCollection();
 };
 
 }
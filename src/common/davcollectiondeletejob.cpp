@@ -20,7 +20,7 @@
 
 #include "daverror.h"
 #include "davjob.h"
-#include "davmanager.h"
+#include "davsession.h"
 
 using namespace KDAV2;
 
@@ -31,7 +31,8 @@ DavCollectionDeleteJob::DavCollectionDeleteJob(const DavUrl &url, QObject *paren
 
 void DavCollectionDeleteJob::start()
 {
-    DavJob *job = DavManager::self()->createDeleteJob(mUrl.url());
+    DavJob *job = session()->createDeleteJob(mUrl.url());
+    prepareJob(job);
     connect(job, &DavJob::result, this, &DavCollectionDeleteJob::davJobFinished);
 }
 
@@ -24,6 +24,7 @@
 #include "daverror.h"
 #include "davjob.h"
 #include "davmanager.h"
+#include "davsession.h"
 #include "davprotocolbase.h"
 #include "utils.h"
 
@@ -40,8 +41,9 @@ void DavCollectionFetchJob::start()
     Q_ASSERT(protocol);
     XMLQueryBuilder::Ptr builder(protocol->collectionsQuery());
 
-    auto job = DavManager::self()->createPropFindJob(
+    auto job = session()->createPropFindJob(
         mCollection.url().url(), builder->buildQuery(), /* depth = */ QStringLiteral("0"));
+    prepareJob(job);
     connect(job, &DavJob::result, this, &DavCollectionFetchJob::davJobFinished);
 }
 
@@ -17,7 +17,7 @@
 */
 
 #include "davcollectionmodifyjob.h"
-#include "davmanager.h"
+#include "davsession.h"
 
 #include "daverror.h"
 #include "utils.h"
@@ -96,7 +96,8 @@ void DavCollectionModifyJob::start()
         }
     }
 
-    auto job = DavManager::self()->createPropPatchJob(mUrl.url(), mQuery);
+    auto job = session()->createPropPatchJob(mUrl.url(), mQuery);
+    prepareJob(job);
     connect(job, &DavJob::result, this, &DavCollectionModifyJob::davJobFinished);
 }
 
@@ -0,0 +1,273 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#include "davcollectionschangecheckjob.h"
+
+#include "daverror.h"
+#include "davjob.h"
+#include "davmultistatusreader.h"
+#include "davsession.h"
+#include "utils.h"
+
+#include "libkdav2_debug.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QStringList>
+#include <QtXml/QDomDocument>
+
+using namespace KDAV2;
+
+class DavCollectionsChangeCheckJobPrivate {
+public:
+    DavCollectionsChangeCheckJobPrivate(Protocol protocol, const QMap<QUrl, QString> &knownTags);
+
+    Protocol mProtocol;
+    QMap<QUrl, QString> mKnownTags;
+    // The collections not found in a response yet, by key
+    QHash<QString, QUrl> mPendingCollections;
+    // The keys of the collections each parent request is about
+    QHash<KJob *, QStringList> mParentRequests;
+    QHash<QString, QString> mCTags;
+    QHash<QString, QString> mSyncTokens;
+    DavUrl::List mChangedCollections;
+    DavUrl::List mRemovedCollections;
+    uint mSubJobCount;
+};
+
+DavCollectionsChangeCheckJobPrivate::DavCollectionsChangeCheckJobPrivate(Protocol protocol, const QMap<QUrl, QString> &knownTags)
+    : mProtocol(protocol)
+    , mKnownTags(knownTags)
+    , mSubJobCount(0)
+{
+}
+
+DavCollectionsChangeCheckJob::DavCollectionsChangeCheckJob(Protocol protocol, const QMap<QUrl, QString> &knownTags, QObject *parent)
+    : DavJobBase(parent)
+    , d(std::unique_ptr<DavCollectionsChangeCheckJobPrivate>(new DavCollectionsChangeCheckJobPrivate(protocol, knownTags)))
+{
+    setPriority(BackgroundPriority);
+}
+
+DavCollectionsChangeCheckJob::~DavCollectionsChangeCheckJob()
+{
+}
+
+void DavCollectionsChangeCheckJob::start()
+{
+    // Group the collections by their parent, the urls keep their user
+    // info so that the credentials are used for the requests
+    QMap<QString, QUrl> parentUrls;
+    QMap<QString, QStringList> parentCollections;
+    for (auto it = d->mKnownTags.constBegin(); it != d->mKnownTags.constEnd(); ++it) {
+        const QUrl parentUrl = it.key().adjusted(QUrl::StripTrailingSlash).adjusted(QUrl::RemoveFilename);
+        const QString parentKey = Utils::canonicalUrl(parentUrl);
+        const QString key = Utils::canonicalUrl(it.key());
+
+        parentUrls.insert(parentKey, parentUrl);
+        parentCollections[parentKey] << key;
+        d->mPendingCollections.insert(key, it.key());
+    }
+
+    if (parentUrls.isEmpty()) {
+        emitResult();
+        return;
+    }
+
+    for (auto it = parentUrls.constBegin(); it != parentUrls.constEnd(); ++it) {
+        // The listing of a server known to leave out the CTags is of no use
+        if (session()->serverQuirks(it.value()).testFlag(DavSession::NoCTagInListing)) {
+            const QStringList keys = parentCollections.value(it.key());
+            for (const QString &key : keys) {
+                checkCollection(key);
+            }
+            continue;
+        }
+
+        DavJob *job = sendRequest(it.value(), QStringLiteral("1"));
+        d->mParentRequests.insert(job, parentCollections.value(it.key()));
+        connect(job, &DavJob::result, this, &DavCollectionsChangeCheckJob::parentChecked);
+    }
+}
+
+DavUrl::List DavCollectionsChangeCheckJob::changedCollections() const
+{
+    return d->mChangedCollections;
+}
+
+DavUrl::List DavCollectionsChangeCheckJob::removedCollections() const
+{
+    return d->mRemovedCollections;
+}
+
+QString DavCollectionsChangeCheckJob::cTag(const QUrl &url) const
+{
+    return d->mCTags.value(Utils::canonicalUrl(url));
+}
+
+QString DavCollectionsChangeCheckJob::syncToken(const QUrl &url) const
+{
+    return d->mSyncTokens.value(Utils::canonicalUrl(url));
+}
+
+DavJob *DavCollectionsChangeCheckJob::sendRequest(const QUrl &url, const QString &depth)
+{
+    /*
+     * Build a query like the following:
+     *
+     * <propfind xmlns="DAV:" xmlns:CS="http://calendarserver.org/ns/">
+     *   <prop>
+     *     <CS:getctag/>
+     *     <sync-token/>
+     *   </prop>
+     * </propfind>
+     */
+    QDomDocument document;
+
+    QDomElement propfindElement = document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("propfind"));
+    document.appendChild(propfindElement);
+
+    QDomElement propElement = document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("prop"));
+    propfindElement.appendChild(propElement);
+
+    propElement.appendChild(document.createElementNS(QStringLiteral("http://calendarserver.org/ns/"), QStringLiteral("getctag")));
+    propElement.appendChild(document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("sync-token")));
+
+    ++d->mSubJobCount;
+    auto job = session()->createPropFindJob(url, document, depth);
+    prepareJob(job);
+    job->setStreaming(true);
+    connect(job, &DavJob::responseParsed, this, [this, job] (const DavMultistatusResponse &response) {
+        processResponse(job, response);
+    });
+    return job;
+}
+
+void DavCollectionsChangeCheckJob::processResponse(DavJob *job, const DavMultistatusResponse &response)
+{
+    /*
+     * Extract the tags from a response like the following:
+     *
+     * <response xmlns="DAV:">
+     *   <href>/calendars/test/work/</href>
+     *   <propstat>
+     *     <prop>
+     *       <CS:getctag xmlns:CS="http://calendarserver.org/ns/">3145</CS:getctag>
+     *       <sync-token>http://example.com/ns/sync/3145</sync-token>
+     *     </prop>
+     *     <status>HTTP/1.1 200 OK</status>
+     *   </propstat>
+     * </response>
+     */
+    const QString href = response.href();
+    QUrl url = job->url();
+    if (href.startsWith(QLatin1Char('/'))) {
+        url.setPath(href, QUrl::TolerantMode);
+    } else {
+        url = QUrl::fromUserInput(href);
+    }
+
+    const QString key = Utils::canonicalUrl(url);
+    const auto pending = d->mPendingCollections.find(key);
+    if (pending == d->mPendingCollections.end()) {
+        // The parent itself, or a collection nobody asked about
+        return;
+    }
+
+    const QDomElement propElement = response.successfulProp();
+    const QString cTag = Utils::firstChildElementNS(propElement, QStringLiteral("http://calendarserver.org/ns/"), QStringLiteral("getctag")).text().trimmed();
+    const QString syncToken = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("sync-token")).text().trimmed();
+
+    if (cTag.isEmpty() && syncToken.isEmpty() && d->mParentRequests.contains(job)) {
+        // Listed without its tags, e.g. by Google, ask the collection itself
+        return;
+    }
+
+    const QUrl collectionUrl = pending.value();
+    d->mPendingCollections.erase(pending);
+
+    if (!cTag.isEmpty()) {
+        d->mCTags.insert(key, cTag);
+    }
+    if (!syncToken.isEmpty()) {
+        d->mSyncTokens.insert(key, syncToken);
+    }
+
+    const QString knownTag = d->mKnownTags.value(collectionUrl);
+    const bool unchanged = !knownTag.isEmpty() && (knownTag == cTag || knownTag == syncToken);
+    if (!unchanged) {
+        d->mChangedCollections << DavUrl(collectionUrl, d->mProtocol);
+    }
+}
+
+void DavCollectionsChangeCheckJob::parentChecked(KJob *job)
+{
+    auto davJob = static_cast<DavJob *>(job);
+    const QStringList keys = d->mParentRequests.take(job);
+
+    if (davJob->error()) {
+        qCDebug(KDAV2_LOG) << "Failed to list" << davJob->url().toDisplayString() << ", checking its collections one by one";
+    }
+
+    // Collections can be missing from the listing of the parent, e.g.
+    // shared ones, or if the parent can't be listed at all
+    for (const QString &key : keys) {
+        checkCollection(key);
+    }
+
+    subjobFinished();
+}
+
+void DavCollectionsChangeCheckJob::checkCollection(const QString &key)
+{
+    const QUrl url = d->mPendingCollections.value(key);
+    if (url.isEmpty()) {
+        return;
+    }
+
+    DavJob *job = sendRequest(url, QStringLiteral("0"));
+    job->setProperty("collectionKey", key);
+    connect(job, &DavJob::result, this, &DavCollectionsChangeCheckJob::collectionChecked);
+}
+
+void DavCollectionsChangeCheckJob::collectionChecked(KJob *job)
+{
+    auto davJob = static_cast<DavJob *>(job);
+    const QUrl url = d->mPendingCollections.take(davJob->property("collectionKey").toString());
+
+    if (davJob->error()) {
+        const int responseCode = davJob->httpStatusCode();
+        if (responseCode == 404 || responseCode == 410) {
+            d->mRemovedCollections << DavUrl(url, d->mProtocol);
+        } else {
+            setErrorFromJob(davJob, ERR_COLLECTIONFETCH);
+        }
+    } else if (!url.isEmpty()) {
+        // The server answered, but not about the collection
+        d->mChangedCollections << DavUrl(url, d->mProtocol);
+    }
+
+    subjobFinished();
+}
+
+void DavCollectionsChangeCheckJob::subjobFinished()
+{
+    if (--d->mSubJobCount == 0) {
+        emitResult();
+    }
+}
@@ -0,0 +1,113 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef KDAV2_DAVCOLLECTIONSCHANGECHECKJOB_H
+#define KDAV2_DAVCOLLECTIONSCHANGECHECKJOB_H
+
+#include "kpimkdav2_export.h"
+
+#include "davjobbase.h"
+#include "davurl.h"
+#include "enums.h"
+
+#include <QtCore/QMap>
+#include <QtCore/QUrl>
+
+#include <memory>
+
+class DavCollectionsChangeCheckJobPrivate;
+
+namespace KDAV2
+{
+
+class DavJob;
+class DavMultistatusResponse;
+
+/**
+ * @short A job that finds out which of a set of DAV collections changed.
+ *
+ * The CTags and sync tokens of all the collections that share a parent,
+ * usually their home set, are fetched with a single Depth: 1 PROPFIND. A
+ * collection that isn't part of the response of its parent, or is listed
+ * there without tags, is checked on its own, and reported as removed if it
+ * doesn't exist anymore. The collections of a server known to leave out
+ * the tags from the listing (see DavSession::NoCTagInListing) are all
+ * checked on their own.
+ */
+class KPIMKDAV2_EXPORT DavCollectionsChangeCheckJob : public DavJobBase
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Creates a new dav collections change check job.
+     *
+     * @param protocol The DAV protocol dialect of the collections.
+     * @param knownTags The collection urls, each with the CTag or sync token
+     *                  it had at the last synchronization.
+     * @param parent The parent object.
+     */
+    DavCollectionsChangeCheckJob(Protocol protocol, const QMap<QUrl, QString> &knownTags, QObject *parent = nullptr);
+
+    ~DavCollectionsChangeCheckJob();
+
+    /**
+     * Starts the job.
+     */
+    void start() Q_DECL_OVERRIDE;
+
+    /**
+     * Returns the collections whose CTag or sync token differs from the
+     * known one, including the ones the server reported neither for.
+     */
+    DavUrl::List changedCollections() const;
+
+    /**
+     * Returns the collections that don't exist anymore.
+     */
+    DavUrl::List removedCollections() const;
+
+    /**
+     * Returns the current CTag of the collection at @p url, if the server
+     * reported one.
+     */
+    QString cTag(const QUrl &url) const;
+
+    /**
+     * Returns the current sync token of the collection at @p url, if the
+     * server reported one.
+     */
+    QString syncToken(const QUrl &url) const;
+
+private Q_SLOTS:
+    void parentChecked(KJob *);
+    void collectionChecked(KJob *);
+
+private:
+    DavJob *sendRequest(const QUrl &url, const QString &depth);
+    void checkCollection(const QString &key);
+    void processResponse(DavJob *job, const DavMultistatusResponse &response);
+    void subjobFinished();
+
+    std::unique_ptr<DavCollectionsChangeCheckJobPrivate> d;
+};
+
+}
+
+#endif
@@ -18,9 +18,10 @@
 
 #include "davcollectionsfetchjob.h"
 
+#include "davdiscoverycache.h"
 #include "davmanager.h"
+#include "davsession.h"
 #include "davprincipalhomesetsfetchjob.h"
-#include "davcollectionfetchjob.h"
 #include "davprotocolbase.h"
 #include "utils.h"
 #include "daverror.h"
@@ -28,20 +29,34 @@
 
 #include "libkdav2_debug.h"
 
-#include <QtCore/QBuffer>
-#include <QtXmlPatterns/QXmlQuery>
-
 using namespace KDAV2;
 
 DavCollectionsFetchJob::DavCollectionsFetchJob(const DavUrl &url, QObject *parent)
-    : DavJobBase(parent), mUrl(url), mSubJobCount(0)
+    : DavJobBase(parent), mAccountUrl(url), mUrl(url), mMaxConcurrentRefreshes(4), mRefreshWhileListing(false),
+      mListedWithCTag(0), mListedWithoutCTag(0), mPendingListings(0), mSubJobCount(0)
+{
+}
+
+void DavCollectionsFetchJob::setMaxConcurrentRefreshes(int count)
+{
+    mMaxConcurrentRefreshes = qMax(1, count);
+}
+
+void DavCollectionsFetchJob::setAdditionalProtocols(const QList<Protocol> &protocols)
 {
+    mAdditionalProtocols = protocols;
 }
 
 void DavCollectionsFetchJob::start()
 {
+    // If the server is known to leave out the CTags, don't wait for the end
+    // of the listing to fetch them individually
+    mRefreshWhileListing = session()->serverQuirks(mUrl.url()).testFlag(DavSession::NoCTagInListing);
+
     if (DavManager::self()->davProtocol(mUrl.protocol())->supportsPrincipals()) {
         DavPrincipalHomeSetsFetchJob *job = new DavPrincipalHomeSetsFetchJob(mUrl);
+        job->setAdditionalProtocols(mAdditionalProtocols);
+        prepareJob(job);
         connect(job, &DavPrincipalHomeSetsFetchJob::result, this, &DavCollectionsFetchJob::principalFetchFinished);
         job->start();
     } else {
@@ -62,10 +77,13 @@ DavUrl DavCollectionsFetchJob::davUrl() const
 void DavCollectionsFetchJob::doCollectionsFetch(const QUrl &url)
 {
     ++mSubJobCount;
+    ++mPendingListings;
 
     const QDomDocument collectionQuery = DavManager::self()->davProtocol(mUrl.protocol())->collectionsQuery()->buildQuery();
-
-    auto job = DavManager::self()->createPropFindJob(url, collectionQuery);
+    auto job = session()->createPropFindJob(url, collectionQuery);
+    prepareJob(job);
+    job->setStreaming(true);
+    connect(job, &DavJob::responseParsed, this, &DavCollectionsFetchJob::processResponse);
     connect(job, &DavJob::result, this, &DavCollectionsFetchJob::collectionsFetchFinished);
 }
 
@@ -115,170 +133,167 @@ void DavCollectionsFetchJob::collectionsFetchFinished(KJob *job)
     auto davJob = static_cast<DavJob *>(job);
 
     if (davJob->error()) {
+        // The cached home sets may be gone, discover them again next time
+        if (davJob->httpStatusCode() == 403 || davJob->httpStatusCode() == 404) {
+            if (DavDiscoveryCache *cache = session()->discoveryCache()) {
+                cache->remove(mAccountUrl, session());
+            }
+            session()->setHomeSets(mUrl.url(), mUrl.protocol(), QStringList());
+        }
         setErrorFromJob(davJob);
-    } else {
-        // For use in the collectionDiscovered() signal
-        QUrl _jobUrl = mUrl.url();
-        _jobUrl.setUserInfo(QString());
-        const QString jobUrl = _jobUrl.toDisplayString();
-
+    } else if (!davJob->isMultistatus()) {
         // Validate that we got a valid PROPFIND response
-        QDomElement rootElement = davJob->response().documentElement();
-        if (rootElement.localName().compare(QStringLiteral("multistatus"), Qt::CaseInsensitive) != 0) {
-            setError(ERR_COLLECTIONFETCH);
-            setErrorTextFromDavError();
-            subjobFinished();
-            return;
-        }
+        setError(ERR_COLLECTIONFETCH);
+        setErrorTextFromDavError();
+    }
 
-        QByteArray resp(davJob->response().toByteArray());
-        QBuffer buffer(&resp);
-        buffer.open(QIODevice::ReadOnly);
+    // Only a server that left out the CTag of every listed collection is
+    // marked, a single new or shared collection without one doesn't count
+    if (--mPendingListings == 0 && !error() && mListedWithoutCTag > 0 && mListedWithCTag == 0) {
+        session()->addServerQuirk(mUrl.url(), DavSession::NoCTagInListing);
+    }
 
-        QXmlQuery xquery;
-        if (!xquery.setFocus(&buffer)) {
-            setError(ERR_COLLECTIONFETCH_XQUERY_SETFOCUS);
-            setErrorTextFromDavError();
-            subjobFinished();
-            return;
-        }
+    refreshIndividualCollections();
+    subjobFinished();
+}
 
-        xquery.setQuery(DavManager::self()->davProtocol(mUrl.protocol())->collectionsXQuery());
-        if (!xquery.isValid()) {
-            setError(ERR_COLLECTIONFETCH_XQUERY_INVALID);
-            setErrorTextFromDavError();
-            subjobFinished();
-            return;
-        }
+void DavCollectionsFetchJob::processResponse(const DavMultistatusResponse &response)
+{
+    if (error()) {
+        return;
+    }
 
-        QString responsesStr;
-        xquery.evaluateTo(&responsesStr);
-        responsesStr.prepend(QStringLiteral("<responses>"));
-        responsesStr.append(QStringLiteral("</responses>"));
+    /*
+     * Extract information from a response like the following:
+     *
+     * <response xmlns="DAV:">
+     *   <href xmlns="DAV:">/caldav.php/test1.user/home/</href>
+     *   <propstat xmlns="DAV:">
+     *     <prop xmlns="DAV:">
+     *       <C:supported-calendar-component-set xmlns:C="urn:ietf:params:xml:ns:caldav">
+     *         <C:comp xmlns:C="urn:ietf:params:xml:ns:caldav" name="VEVENT"/>
+     *         <C:comp xmlns:C="urn:ietf:params:xml:ns:caldav" name="VTODO"/>
+     *         <C:comp xmlns:C="urn:ietf:params:xml:ns:caldav" name="VJOURNAL"/>
+     *         <C:comp xmlns:C="urn:ietf:params:xml:ns:caldav" name="VTIMEZONE"/>
+     *         <C:comp xmlns:C="urn:ietf:params:xml:ns:caldav" name="VFREEBUSY"/>
+     *       </C:supported-calendar-component-set>
+     *       <resourcetype xmlns="DAV:">
+     *         <collection xmlns="DAV:"/>
+     *         <C:calendar xmlns:C="urn:ietf:params:xml:ns:caldav"/>
+     *         <C:schedule-calendar xmlns:C="urn:ietf:params:xml:ns:caldav"/>
+     *       </resourcetype>
+     *       <displayname xmlns="DAV:">Test1 User</displayname>
+     *       <current-user-privilege-set xmlns="DAV:">
+     *         <privilege xmlns="DAV:">
+     *           <read xmlns="DAV:"/>
+     *         </privilege>
+     *       </current-user-privilege-set>
+     *       <getctag xmlns="http://calendarserver.org/ns/">12345</getctag>
+     *     </prop>
+     *     <status xmlns="DAV:">HTTP/1.1 200 OK</status>
+     *   </propstat>
+     * </response>
+     */
+
+    const DavProtocolBase *protocol = DavManager::self()->davProtocol(mUrl.protocol());
+    const QDomElement responseElement = response.element();
+    if (!protocol->isCollectionResponse(responseElement)) {
+        return;
+    }
 
-        QDomDocument document;
-        if (!document.setContent(responsesStr, true)) {
-            setError(ERR_COLLECTIONFETCH);
-            setErrorTextFromDavError();
-            subjobFinished();
-            return;
+    DavCollection collection;
+    if (!Utils::extractCollection(responseElement, mUrl, collection)) {
+        return;
+    }
+
+    // don't add this resource if it has already been detected
+    const QString url = Utils::canonicalUrl(collection.url().url());
+    if (mCollectionUrls.contains(url)) {
+        return;
+    }
+    mCollectionUrls.insert(url);
+
+    if (protocol->supportsCTags() && collection.CTag().isEmpty()) {
+        qCDebug(KDAV2_LOG) << "No CTag found for"
+            << collection.url().url().toDisplayString()
+            << "from the home set, trying from the direct URL";
+        ++mListedWithoutCTag;
+        mCollectionsWithoutCTag << collection;
+        if (mRefreshWhileListing) {
+            refreshIndividualCollections();
         }
+        return;
+    }
 
-        if (!error()) {
-            /*
-             * Extract information from a document like the following:
-             *
-             * <responses>
-             *   <response xmlns="DAV:">
-             *     <href xmlns="DAV:">/caldav.php/test1.user/home/</href>
-             *     <propstat xmlns="DAV:">
-             *       <prop xmlns="DAV:">
-             *         <C:supported-calendar-component-set xmlns:C="urn:ietf:params:xml:ns:caldav">
-             *           <C:comp xmlns:C="urn:ietf:params:xml:ns:caldav" name="VEVENT"/>
-             *           <C:comp xmlns:C="urn:ietf:params:xml:ns:caldav" name="VTODO"/>
-             *           <C:comp xmlns:C="urn:ietf:params:xml:ns:caldav" name="VJOURNAL"/>
-             *           <C:comp xmlns:C="urn:ietf:params:xml:ns:caldav" name="VTIMEZONE"/>
-             *           <C:comp xmlns:C="urn:ietf:params:xml:ns:caldav" name="VFREEBUSY"/>
-             *         </C:supported-calendar-component-set>
-             *         <resourcetype xmlns="DAV:">
-             *           <collection xmlns="DAV:"/>
-             *           <C:calendar xmlns:C="urn:ietf:params:xml:ns:caldav"/>
-             *           <C:schedule-calendar xmlns:C="urn:ietf:params:xml:ns:caldav"/>
-             *         </resourcetype>
-             *         <displayname xmlns="DAV:">Test1 User</displayname>
-             *         <current-user-privilege-set xmlns="DAV:">
-             *           <privilege xmlns="DAV:">
-             *             <read xmlns="DAV:"/>
-             *           </privilege>
-             *         </current-user-privilege-set>
-             *         <getctag xmlns="http://calendarserver.org/ns/">12345</getctag>
-             *       </prop>
-             *       <status xmlns="DAV:">HTTP/1.1 200 OK</status>
-             *     </propstat>
-             *   </response>
-             * </responses>
-             */
-
-            const QDomElement responsesElement = document.documentElement();
-
-            QDomElement responseElement = Utils::firstChildElementNS(
-                responsesElement, QStringLiteral("DAV:"), QStringLiteral("response"));
-            while (!responseElement.isNull()) {
-
-                DavCollection collection;
-                if (!Utils::extractCollection(responseElement, mUrl, collection)) {
-                    continue;
-                }
-
-                QUrl url = collection.url().url();
-
-                // don't add this resource if it has already been detected
-                bool alreadySeen = false;
-                foreach (const DavCollection &seen, mCollections) {
-                    if (seen.url().toDisplayString() == url.toDisplayString()) {
-                        alreadySeen = true;
-                    }
-                }
-                if (alreadySeen) {
-                    responseElement = Utils::nextSiblingElementNS(
-                        responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
-                    continue;
-                }
-
-                bool protocolSupportsCTags = DavManager::self()->davProtocol(mUrl.protocol())->supportsCTags();
-                if (protocolSupportsCTags && collection.CTag() == "") {
-                    qCDebug(KDAV2_LOG) << "No CTag found for"
-                        << collection.url().url().toDisplayString()
-                        << "from the home set, trying from the direct URL";
-                    refreshIndividualCollection(collection);
-
-                    responseElement = Utils::nextSiblingElementNS(
-                        responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
-                    continue;
-                }
-
-                mCollections << collection;
-                Q_EMIT collectionDiscovered(mUrl.protocol(), url.toDisplayString(), jobUrl);
-
-                responseElement = Utils::nextSiblingElementNS(
-                    responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
-            }
+    if (protocol->supportsCTags()) {
+        // The server lists the CTags again
+        if (mListedWithCTag++ == 0) {
+            session()->removeServerQuirk(mUrl.url(), DavSession::NoCTagInListing);
+            mRefreshWhileListing = false;
         }
     }
 
-    subjobFinished();
+    addCollection(collection);
+}
+
+void DavCollectionsFetchJob::addCollection(const DavCollection &collection)
+{
+    // For use in the collectionDiscovered() signal
+    QUrl jobUrl = mUrl.url();
+    jobUrl.setUserInfo(QString());
+
+    mCollections << collection;
+    Q_EMIT collectionDiscovered(mUrl.protocol(), collection.url().url().toDisplayString(), jobUrl.toDisplayString());
 }
 
 // This is a workaroud for Google who doesn't support providing the CTag
-// directly from the home set. We refresh the collections individually from
-// their own URLs, but only if we haven't found a CTag with the home set
-// request.
-void DavCollectionsFetchJob::refreshIndividualCollection(const DavCollection &collection)
+// directly from the home set. We ask for the CTags of the collections
+// individually from their own URLs, but only if we haven't found one with
+// the home set request. All the other properties are known already.
+void DavCollectionsFetchJob::refreshIndividualCollections()
 {
-    ++mSubJobCount;
-    auto individualFetchJob = new DavCollectionFetchJob(collection, this);
-    connect(individualFetchJob, &DavCollectionFetchJob::result, this, &DavCollectionsFetchJob::individualCollectionRefreshed);
-    individualFetchJob->start();
+    while (mRefreshedCollections.size() < mMaxConcurrentRefreshes && !mCollectionsWithoutCTag.isEmpty()) {
+        const DavCollection collection = mCollectionsWithoutCTag.takeFirst();
+
+        QDomDocument document;
+        QDomElement propfindElement = document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("propfind"));
+        document.appendChild(propfindElement);
+        QDomElement propElement = document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("prop"));
+        propfindElement.appendChild(propElement);
+        propElement.appendChild(document.createElementNS(QStringLiteral("http://calendarserver.org/ns/"), QStringLiteral("getctag")));
+
+        ++mSubJobCount;
+        auto job = session()->createPropFindJob(collection.url().url(), document, QStringLiteral("0"));
+        prepareJob(job);
+        mRefreshedCollections.insert(job, collection);
+        connect(job, &DavJob::result, this, &DavCollectionsFetchJob::individualCollectionRefreshed);
+    }
 }
 
 void DavCollectionsFetchJob::individualCollectionRefreshed(KJob *job)
 {
-    const auto *davJob = qobject_cast<DavCollectionFetchJob *>(job);
+    auto davJob = static_cast<DavJob *>(job);
+    DavCollection collection = mRefreshedCollections.take(job);
 
     if (davJob->error()) {
-        setDavError(davJob->davError());
-        emitResult();
-        return;
-    }
+        setErrorFromJob(davJob, ERR_COLLECTIONFETCH);
+    } else {
+        const QDomNodeList ctags = davJob->response().elementsByTagNameNS(QStringLiteral("http://calendarserver.org/ns/"), QStringLiteral("getctag"));
+        if (!ctags.isEmpty()) {
+            collection.setCTag(ctags.item(0).toElement().text());
+        }
+
+        qCDebug(KDAV2_LOG) << "Collection"
+            << collection.url().url().toDisplayString() << "refreshed";
 
-    qCDebug(KDAV2_LOG) << "Collection"
-        << davJob->collection().url().url().toDisplayString() << "refreshed";
+        if (collection.CTag().isEmpty()) {
+            qWarning() << "Collection with an empty CTag";
+        }
 
-    if (davJob->collection().CTag() == "") {
-        qWarning() << "Collection with an empty CTag";
+        addCollection(collection);
     }
 
-    mCollections << davJob->collection();
+    refreshIndividualCollections();
     subjobFinished();
 }
 
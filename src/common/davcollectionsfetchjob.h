@@ -26,10 +26,15 @@
 #include "davurl.h"
 
 #include <KCoreAddons/KJob>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QSet>
 
 namespace KDAV2
 {
 
+class DavMultistatusResponse;
+
 /**
  * @short A job that fetches all DAV collection.
  *
@@ -54,6 +59,28 @@ public:
      */
     void start() Q_DECL_OVERRIDE;
 
+    /**
+     * Sets the maximum number of collections whose CTag is fetched at the
+     * same time, if the server doesn't include them in the listing of the
+     * home set.
+     *
+     * Once a server of the session is known to leave out all the CTags (see
+     * DavSession::NoCTagInListing), they are fetched while the listing is
+     * still going on. The server is known so after a listing without any
+     * CTag, and not anymore after one with CTags.
+     *
+     * Defaults to 4.
+     */
+    void setMaxConcurrentRefreshes(int count);
+
+    /**
+     * Sets further @p protocols whose home sets are looked up together with
+     * the ones of this job, for later jobs on the same url.
+     *
+     * @see DavPrincipalHomeSetsFetchJob::setAdditionalProtocols()
+     */
+    void setAdditionalProtocols(const QList<Protocol> &protocols);
+
     /**
      * Returns the list of fetched DAV collections.
      */
@@ -80,11 +107,27 @@ private Q_SLOTS:
 
 private:
     void doCollectionsFetch(const QUrl &url);
-    void refreshIndividualCollection(const DavCollection &);
+    void processResponse(const DavMultistatusResponse &response);
+    void refreshIndividualCollections();
+    void addCollection(const DavCollection &collection);
     void subjobFinished();
 
+    // The url given to the job, the key in the discovery cache
+    const DavUrl mAccountUrl;
     DavUrl mUrl;
+    QList<Protocol> mAdditionalProtocols;
     DavCollection::List mCollections;
+    // Found without CTag, waiting to be refreshed
+    DavCollection::List mCollectionsWithoutCTag;
+    QHash<KJob *, DavCollection> mRefreshedCollections;
+    // The canonical urls of all the collections listed so far
+    QSet<QString> mCollectionUrls;
+    int mMaxConcurrentRefreshes;
+    bool mRefreshWhileListing;
+    // The collections of the listings with and without CTag
+    int mListedWithCTag;
+    int mListedWithoutCTag;
+    uint mPendingListings;
     uint mSubJobCount;
 };
 
@@ -19,24 +19,86 @@
 #include "davcollectionsmultifetchjob.h"
 
 #include "davcollectionsfetchjob.h"
+#include "utils.h"
 
 using namespace KDAV2;
 
 DavCollectionsMultiFetchJob::DavCollectionsMultiFetchJob(const DavUrl::List &urls, QObject *parent)
-    : KJob(parent), mUrls(urls), mSubJobCount(urls.size())
+    : KJob(parent), mUrls(urls), mSession(nullptr), mMaxConcurrentJobs(4), mRunningJobs(0), mSubJobCount(urls.size())
 {
 }
 
+void DavCollectionsMultiFetchJob::setSession(DavSession *session)
+{
+    mSession = session;
+}
+
+void DavCollectionsMultiFetchJob::setMaxConcurrentJobs(int count)
+{
+    mMaxConcurrentJobs = qMax(1, count);
+}
+
+int DavCollectionsMultiFetchJob::maxConcurrentJobs() const
+{
+    return mMaxConcurrentJobs;
+}
+
 void DavCollectionsMultiFetchJob::start()
 {
     if (mUrls.isEmpty()) {
         emitResult();
+        return;
     }
 
+    // The urls of an account often differ by the protocol only. The first
+    // job of such a group asks for the home sets of all the protocols at
+    // once, the others find them in the session when they start. The same
+    // url given twice, even spelled differently, is fetched once. The user
+    // name is kept apart, it tells the accounts of a server apart.
+    QStringList groupOrder;
+    QHash<QString, DavUrl::List> groups;
+    QSet<QString> seenUrls;
     foreach (const DavUrl &url, mUrls) {
-        DavCollectionsFetchJob *job = new DavCollectionsFetchJob(url, this);
+        const QString groupKey = url.url().userName() + QLatin1Char('@') + Utils::canonicalUrl(url.url());
+        const QString key = QString::number(url.protocol()) + QLatin1Char(' ') + groupKey;
+        if (seenUrls.contains(key)) {
+            continue;
+        }
+        seenUrls.insert(key);
+
+        if (!groups.contains(groupKey)) {
+            groupOrder << groupKey;
+        }
+        groups[groupKey] << url;
+    }
+    mSubJobCount = seenUrls.size();
+
+    foreach (const QString &groupKey, groupOrder) {
+        mPendingGroups << groups.value(groupKey);
+    }
+
+    startPendingJobs();
+}
+
+void DavCollectionsMultiFetchJob::startPendingJobs()
+{
+    while (mRunningJobs < mMaxConcurrentJobs && !mPendingGroups.isEmpty()) {
+        const DavUrl::List group = mPendingGroups.takeFirst();
+        QList<Protocol> otherProtocols;
+        for (int i = 1; i < group.size(); ++i) {
+            otherProtocols << group.at(i).protocol();
+        }
+
+        DavCollectionsFetchJob *job = new DavCollectionsFetchJob(group.first(), this);
+        job->setSession(mSession);
+        job->setAdditionalProtocols(otherProtocols);
         connect(job, &DavCollectionsFetchJob::result, this, &DavCollectionsMultiFetchJob::davJobFinished);
-        connect(job, &DavCollectionsFetchJob::collectionDiscovered, this, &DavCollectionsMultiFetchJob::collectionDiscovered);
+        connect(job, &DavCollectionsFetchJob::collectionDiscovered, this, &DavCollectionsMultiFetchJob::subJobCollectionDiscovered);
+        if (group.size() > 1) {
+            mWaitingUrls.insert(job, group.mid(1));
+        }
+
+        ++mRunningJobs;
         job->start();
     }
 }
@@ -46,19 +108,55 @@ DavCollection::List DavCollectionsMultiFetchJob::collections() const
     return mCollections;
 }
 
+bool DavCollectionsMultiFetchJob::doKill()
+{
+    mPendingGroups.clear();
+    mWaitingUrls.clear();
+
+    const auto jobs = findChildren<DavCollectionsFetchJob *>(QString(), Qt::FindDirectChildrenOnly);
+    for (DavCollectionsFetchJob *job : jobs) {
+        job->kill(KJob::Quietly);
+    }
+    return true;
+}
+
+void DavCollectionsMultiFetchJob::subJobCollectionDiscovered(int protocol, const QString &collectionUrl, const QString &configuredUrl)
+{
+    const QString key = Utils::canonicalUrl(QUrl(collectionUrl));
+    if (mDiscoveredUrls.contains(key)) {
+        return;
+    }
+    mDiscoveredUrls.insert(key);
+
+    Q_EMIT collectionDiscovered(protocol, collectionUrl, configuredUrl);
+}
+
 void DavCollectionsMultiFetchJob::davJobFinished(KJob *job)
 {
     DavCollectionsFetchJob *fetchJob = qobject_cast<DavCollectionsFetchJob *>(job);
+    --mRunningJobs;
 
     if (job->error()) {
         setError(job->error());
         setErrorText(job->errorText());
     } else {
-        mCollections << fetchJob->collections();
+        foreach (const DavCollection &collection, fetchJob->collections()) {
+            const QString key = Utils::canonicalUrl(collection.url().url());
+            if (!mCollectionUrls.contains(key)) {
+                mCollectionUrls.insert(key);
+                mCollections << collection;
+            }
+        }
+    }
+
+    // The rest of the group goes first, its home sets are known now
+    const DavUrl::List waitingUrls = mWaitingUrls.take(job);
+    for (int i = 0; i < waitingUrls.size(); ++i) {
+        mPendingGroups.insert(i, DavUrl::List() << waitingUrls.at(i));
     }
+    startPendingJobs();
 
     if (--mSubJobCount == 0) {
         emitResult();
     }
 }
-
@@ -26,9 +26,15 @@
 
 #include <KCoreAddons/KJob>
 
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+
 namespace KDAV2
 {
 
+class DavCollectionsFetchJob;
+class DavSession;
+
 /**
  * @short A job that fetches all DAV collection.
  *
@@ -36,7 +42,9 @@ namespace KDAV2
  * under a certain list of DAV urls.
  *
  * @note This class just combines multiple calls of DavCollectionsFetchJob
- *       into one job.
+ *       into one job. A collection found under several urls, e.g. a
+ *       calendar shared with several accounts, is only reported once, and
+ *       an url given several times is only fetched once.
  */
 class KPIMKDAV2_EXPORT DavCollectionsMultiFetchJob : public KJob
 {
@@ -51,6 +59,26 @@ public:
      */
     explicit DavCollectionsMultiFetchJob(const DavUrl::List &urls, QObject *parent = nullptr);
 
+    /**
+     * Sets the @p session the collections are fetched with.
+     *
+     * @see DavJobBase::setSession()
+     */
+    void setSession(DavSession *session);
+
+    /**
+     * Sets the maximum number of urls whose collections are fetched at the
+     * same time, the others wait for their turn.
+     *
+     * Defaults to 4.
+     */
+    void setMaxConcurrentJobs(int count);
+
+    /**
+     * Returns the maximum number of urls fetched at the same time.
+     */
+    int maxConcurrentJobs() const;
+
     /**
      * Starts the job.
      */
@@ -61,6 +89,12 @@ public:
      */
     DavCollection::List collections() const;
 
+protected:
+    /**
+     * Kills the fetch jobs of all the urls.
+     */
+    bool doKill() Q_DECL_OVERRIDE;
+
 Q_SIGNALS:
     /**
      * This signal is emitted every time a new collection has been discovered.
@@ -72,10 +106,25 @@ Q_SIGNALS:
 
 private Q_SLOTS:
     void davJobFinished(KJob *);
+    void subJobCollectionDiscovered(int protocol, const QString &collectionUrl, const QString &configuredUrl);
 
 private:
+    void startPendingJobs();
+
     DavUrl::List mUrls;
+    // The urls not fetched yet, grouped by the urls that differ by the
+    // protocol only
+    QList<DavUrl::List> mPendingGroups;
+    // The urls that differ from the one of a running job by the protocol
+    // only, they are fetched once it is done
+    QHash<KJob *, DavUrl::List> mWaitingUrls;
     DavCollection::List mCollections;
+    // The canonical urls of the collections reported so far
+    QSet<QString> mDiscoveredUrls;
+    QSet<QString> mCollectionUrls;
+    DavSession *mSession;
+    int mMaxConcurrentJobs;
+    int mRunningJobs;
     uint mSubJobCount;
 };
 
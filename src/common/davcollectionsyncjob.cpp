@@ -0,0 +1,287 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#include "davcollectionsyncjob.h"
+
+#include "daverror.h"
+#include "davjob.h"
+#include "davmanager.h"
+#include "davprotocolbase.h"
+#include "davsession.h"
+#include "utils.h"
+
+#include "libkdav2_debug.h"
+
+#include <QtCore/QMap>
+
+using namespace KDAV2;
+
+class DavCollectionSyncJobPrivate {
+public:
+    DavCollectionSyncJobPrivate(const DavUrl &url, const QString &syncToken);
+
+    DavUrl mUrl;
+    QString mSyncToken;
+    // Keyed by the url of the item, an item can be reported several
+    // times if the results are truncated
+    QMap<QString, DavItem> mChangedItems;
+    QMap<QString, DavUrl> mRemovedItems;
+    // The current response is truncated
+    bool mTruncated;
+    // The server stopped moving forward while truncating
+    bool mIncomplete;
+};
+
+DavCollectionSyncJobPrivate::DavCollectionSyncJobPrivate(const DavUrl &url, const QString &syncToken)
+    : mUrl(url)
+    , mSyncToken(syncToken)
+    , mTruncated(false)
+    , mIncomplete(false)
+{
+}
+
+DavCollectionSyncJob::DavCollectionSyncJob(const DavUrl &url, const QString &syncToken, QObject *parent)
+    : DavJobBase(parent)
+    , d(std::unique_ptr<DavCollectionSyncJobPrivate>(new DavCollectionSyncJobPrivate(url, syncToken)))
+{
+    setPriority(BackgroundPriority);
+}
+
+DavCollectionSyncJob::~DavCollectionSyncJob()
+{
+}
+
+void DavCollectionSyncJob::start()
+{
+    const DavProtocolBase *protocol = DavManager::self()->davProtocol(d->mUrl.protocol());
+    if (!protocol || !protocol->supportsSyncCollection()) {
+        setError(ERR_COLLECTIONSYNC_NOT_SUPPORTED);
+        setErrorTextFromDavError();
+        emitResult();
+        return;
+    }
+
+    sendRequest();
+}
+
+DavItem::List DavCollectionSyncJob::changedItems() const
+{
+    return d->mChangedItems.values().toVector();
+}
+
+DavUrl::List DavCollectionSyncJob::removedItems() const
+{
+    return d->mRemovedItems.values().toVector();
+}
+
+QString DavCollectionSyncJob::syncToken() const
+{
+    return d->mSyncToken;
+}
+
+bool DavCollectionSyncJob::isTruncated() const
+{
+    return d->mIncomplete;
+}
+
+void DavCollectionSyncJob::sendRequest()
+{
+    /*
+     * Build a query like the following:
+     *
+     * <sync-collection xmlns="DAV:">
+     *   <sync-token>http://example.com/ns/sync/1234</sync-token>
+     *   <sync-level>1</sync-level>
+     *   <prop>
+     *     <getetag/>
+     *     <getcontenttype/>
+     *     <resourcetype/>
+     *   </prop>
+     * </sync-collection>
+     */
+    QDomDocument document;
+
+    QDomElement syncCollectionElement = document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("sync-collection"));
+    document.appendChild(syncCollectionElement);
+
+    QDomElement syncTokenElement = document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("sync-token"));
+    syncTokenElement.appendChild(document.createTextNode(d->mSyncToken));
+    syncCollectionElement.appendChild(syncTokenElement);
+
+    QDomElement syncLevelElement = document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("sync-level"));
+    syncLevelElement.appendChild(document.createTextNode(QStringLiteral("1")));
+    syncCollectionElement.appendChild(syncLevelElement);
+
+    QDomElement propElement = document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("prop"));
+    syncCollectionElement.appendChild(propElement);
+    propElement.appendChild(document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("getetag")));
+    propElement.appendChild(document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("getcontenttype")));
+    propElement.appendChild(document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("resourcetype")));
+
+    // RFC 6578 only defines the report for a Depth of 0, sync-level is used instead
+    auto job = session()->createReportJob(d->mUrl.url(), document, QStringLiteral("0"));
+    prepareJob(job);
+    job->setStreaming(true);
+    connect(job, &DavJob::responseParsed, this, [this, job] (const DavMultistatusResponse &response) {
+        processResponse(job, response);
+    });
+    connect(job, &DavJob::result, this, &DavCollectionSyncJob::davJobFinished);
+}
+
+void DavCollectionSyncJob::davJobFinished(KJob *job)
+{
+    auto davJob = static_cast<DavJob *>(job);
+
+    if (davJob->error()) {
+        // The DAV:valid-sync-token precondition fails if the server doesn't
+        // know the token anymore, the client has to start all over again
+        const int status = davJob->httpStatusCode();
+        if ((status == 403 || status == 409) && davJob->data().contains("valid-sync-token")) {
+            setErrorFromJob(davJob, ERR_COLLECTIONSYNC_INVALID_TOKEN);
+        } else {
+            setErrorFromJob(davJob, ERR_COLLECTIONSYNC);
+        }
+        emitResult();
+        return;
+    }
+
+    if (!davJob->isMultistatus()) {
+        setError(ERR_COLLECTIONSYNC);
+        setErrorTextFromDavError();
+        emitResult();
+        return;
+    }
+
+    const QString syncToken = davJob->syncToken();
+    const bool truncated = d->mTruncated;
+    d->mTruncated = false;
+
+    // The results have been truncated, the token points to what has been
+    // reported so far, so ask for the rest. Stop if the server doesn't move
+    // forward to not loop forever.
+    if (truncated && !syncToken.isEmpty() && syncToken != d->mSyncToken) {
+        d->mSyncToken = syncToken;
+        sendRequest();
+        return;
+    }
+
+    if (truncated) {
+        qCWarning(KDAV2_LOG) << "The server truncated the changes of" << d->mUrl.url().toDisplayString(QUrl::RemoveUserInfo)
+                             << "without moving the sync token forward";
+        d->mIncomplete = true;
+    }
+
+    if (!syncToken.isEmpty()) {
+        d->mSyncToken = syncToken;
+    }
+
+    emitResult();
+}
+
+void DavCollectionSyncJob::processResponse(DavJob *davJob, const DavMultistatusResponse &response)
+{
+    /*
+     * Extract data from responses like the following:
+     *
+     * <response xmlns="DAV:">
+     *   <href>/calendars/test/changed.ics</href>
+     *   <propstat>
+     *     <prop>
+     *       <getetag>"00001-abcd1"</getetag>
+     *       <getcontenttype>text/calendar; charset=utf-8</getcontenttype>
+     *     </prop>
+     *     <status>HTTP/1.1 200 OK</status>
+     *   </propstat>
+     * </response>
+     * <response xmlns="DAV:">
+     *   <href>/calendars/test/removed.ics</href>
+     *   <status>HTTP/1.1 404 Not Found</status>
+     * </response>
+     * <response xmlns="DAV:">
+     *   <href>/calendars/test/</href>
+     *   <status>HTTP/1.1 507 Insufficient Storage</status>
+     *   <error><number-of-matches-within-limits/></error>
+     * </response>
+     */
+
+    const QString href = response.href();
+
+    QUrl url = davJob->url();
+    url.setUserInfo(QString());
+    if (href.startsWith(QLatin1Char('/'))) {
+        // href is only a path, use request url to complete
+        url.setPath(href, QUrl::TolerantMode);
+    } else {
+        // href is a complete url
+        url = QUrl::fromUserInput(href);
+    }
+
+    QString path = url.path();
+    QString collectionPath = davJob->url().path();
+    if (!path.endsWith(QLatin1Char('/'))) {
+        path.append(QLatin1Char('/'));
+    }
+    if (!collectionPath.endsWith(QLatin1Char('/'))) {
+        collectionPath.append(QLatin1Char('/'));
+    }
+
+    // The collection itself only shows up to tell that the results
+    // have been truncated
+    if (path == collectionPath) {
+        if (response.status().contains(QStringLiteral("507"))) {
+            d->mTruncated = true;
+        }
+        return;
+    }
+
+    const QString key = url.toDisplayString();
+    url.setUserInfo(d->mUrl.url().userInfo());
+    const DavUrl itemUrl(url, d->mUrl.protocol());
+
+    if (response.status().contains(QStringLiteral("404"))) {
+        d->mChangedItems.remove(key);
+        d->mRemovedItems.insert(key, itemUrl);
+        return;
+    }
+
+    const QDomElement propElement = response.successfulProp();
+    if (propElement.isNull()) {
+        return;
+    }
+
+    // Skip the sub collections
+    const QDomElement resourcetypeElement = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("resourcetype"));
+    const QDomElement collectionElement = Utils::firstChildElementNS(resourcetypeElement, QStringLiteral("DAV:"), QStringLiteral("collection"));
+    if (!collectionElement.isNull()) {
+        return;
+    }
+
+    DavItem item;
+    item.setUrl(itemUrl);
+
+    const QDomElement getetagElement = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("getetag"));
+    item.setEtag(getetagElement.text());
+
+    //"text/calendar; charset=utf-8" -> "text/calendar"
+    const QDomElement getcontenttypeElement = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("getcontenttype"));
+    item.setContentType(getcontenttypeElement.text().split(QLatin1Char(';')).first().trimmed());
+
+    d->mRemovedItems.remove(key);
+    d->mChangedItems.insert(key, item);
+}
@@ -0,0 +1,115 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef KDAV2_DAVCOLLECTIONSYNCJOB_H
+#define KDAV2_DAVCOLLECTIONSYNCJOB_H
+
+#include "kpimkdav2_export.h"
+
+#include "davitem.h"
+#include "davjobbase.h"
+#include "davurl.h"
+
+#include <memory>
+
+class DavCollectionSyncJobPrivate;
+
+namespace KDAV2
+{
+
+class DavJob;
+class DavMultistatusResponse;
+
+/**
+ * @short A job that fetches the changes of a DAV collection.
+ *
+ * This job sends a sync-collection REPORT as defined in RFC 6578, so that
+ * only the items that changed since the last synchronization are reported
+ * instead of all the items of the collection.
+ *
+ * If the server truncates the results, the job continues with the sync
+ * token it got until all the changes have been fetched. If the server
+ * truncates them without moving the sync token forward, the job stops
+ * with the changes it got so far and isTruncated() returns true.
+ *
+ * If the sync token is no longer valid the job fails with the
+ * ERR_COLLECTIONSYNC_INVALID_TOKEN error, the collection then has to
+ * be listed again, e.g. with an empty sync token.
+ */
+class KPIMKDAV2_EXPORT DavCollectionSyncJob : public DavJobBase
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Creates a new dav collection sync job.
+     *
+     * @param url The url of the DAV collection.
+     * @param syncToken The sync token returned by the previous synchronization,
+     *                  or an empty string to get all the items of the collection.
+     * @param parent The parent object.
+     */
+    explicit DavCollectionSyncJob(const DavUrl &url, const QString &syncToken = QString(), QObject *parent = nullptr);
+
+    ~DavCollectionSyncJob();
+
+    /**
+     * Starts the job.
+     */
+    void start() Q_DECL_OVERRIDE;
+
+    /**
+     * Returns the items that have been added or changed since the
+     * synchronization of the given sync token, with their url and etag.
+     */
+    DavItem::List changedItems() const;
+
+    /**
+     * Returns the urls of the items that have been removed since the
+     * synchronization of the given sync token.
+     */
+    DavUrl::List removedItems() const;
+
+    /**
+     * Returns the new sync token, to be used for the next synchronization.
+     */
+    QString syncToken() const;
+
+    /**
+     * Returns whether the changes are incomplete, because the server
+     * truncated them without moving the sync token forward.
+     *
+     * The changes and the sync token reported are still valid, but the
+     * collection should be listed as a whole to catch up.
+     */
+    bool isTruncated() const;
+
+private Q_SLOTS:
+    void davJobFinished(KJob *);
+
+private:
+    void sendRequest();
+    void processResponse(DavJob *job, const DavMultistatusResponse &response);
+
+    std::unique_ptr<DavCollectionSyncJobPrivate> d;
+};
+
+}
+
+#endif
@@ -0,0 +1,164 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#include "davcookiejar.h"
+
+#include "libkdav2_debug.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtNetwork/QNetworkCookie>
+
+using namespace KDAV2;
+
+// Servers tend to repeat the same cookies in every response, in a
+// different order at times
+static bool sameCookies(const QList<QNetworkCookie> &a, const QList<QNetworkCookie> &b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    foreach (const QNetworkCookie &cookie, a) {
+        if (!b.contains(cookie)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+DavCookieJar::DavCookieJar(const QString &fileName, QObject *parent)
+    : QNetworkCookieJar(parent)
+    , mFileName(fileName)
+{
+    // Several responses in a row often update the cookies, write them once
+    mSaveTimer.setSingleShot(true);
+    mSaveTimer.setInterval(1000);
+    connect(&mSaveTimer, &QTimer::timeout, this, [this] () {
+        save();
+    });
+
+    load();
+}
+
+DavCookieJar::~DavCookieJar()
+{
+    if (mSaveTimer.isActive()) {
+        save();
+    }
+}
+
+QString DavCookieJar::fileName() const
+{
+    return mFileName;
+}
+
+bool DavCookieJar::load()
+{
+    if (mFileName.isEmpty()) {
+        return false;
+    }
+
+    QFile file(mFileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    QList<QNetworkCookie> cookies;
+    // One cookie per line, in the form of a Set-Cookie header
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        for (const QNetworkCookie &cookie : QNetworkCookie::parseCookies(line)) {
+            if (cookie.isSessionCookie() || cookie.expirationDate() > now) {
+                cookies << cookie;
+            }
+        }
+    }
+    setAllCookies(cookies);
+    return true;
+}
+
+bool DavCookieJar::save() const
+{
+    if (mFileName.isEmpty()) {
+        return false;
+    }
+
+    if (!QDir().mkpath(QFileInfo(mFileName).absolutePath())) {
+        qCWarning(KDAV2_LOG) << "Failed to create the directory of the cookie file" << mFileName;
+        return false;
+    }
+
+    QSaveFile file(mFileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(KDAV2_LOG) << "Failed to write the cookie file" << mFileName << file.errorString();
+        return false;
+    }
+    // Only the user may read the cookies, they grant access to the accounts
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+
+    for (const QNetworkCookie &cookie : allCookies()) {
+        file.write(cookie.toRawForm(QNetworkCookie::Full));
+        file.write("\n");
+    }
+
+    if (!file.commit()) {
+        qCWarning(KDAV2_LOG) << "Failed to write the cookie file" << mFileName << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void DavCookieJar::clear()
+{
+    mSaveTimer.stop();
+    setAllCookies(QList<QNetworkCookie>());
+    if (!mFileName.isEmpty()) {
+        QFile::remove(mFileName);
+    }
+}
+
+bool DavCookieJar::setCookiesFromUrl(const QList<QNetworkCookie> &cookieList, const QUrl &url)
+{
+    const QList<QNetworkCookie> previousCookies = allCookies();
+    const bool accepted = QNetworkCookieJar::setCookiesFromUrl(cookieList, url);
+    if (accepted && !sameCookies(previousCookies, allCookies())) {
+        scheduleSave();
+    }
+    return accepted;
+}
+
+bool DavCookieJar::deleteCookie(const QNetworkCookie &cookie)
+{
+    const bool deleted = QNetworkCookieJar::deleteCookie(cookie);
+    if (deleted) {
+        scheduleSave();
+    }
+    return deleted;
+}
+
+void DavCookieJar::scheduleSave()
+{
+    if (!mFileName.isEmpty() && !mSaveTimer.isActive()) {
+        mSaveTimer.start();
+    }
+}
@@ -0,0 +1,92 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef KDAV2_DAVCOOKIEJAR_H
+#define KDAV2_DAVCOOKIEJAR_H
+
+#include "kpimkdav2_export.h"
+
+#include <QtCore/QString>
+#include <QtCore/QTimer>
+#include <QtNetwork/QNetworkCookieJar>
+
+namespace KDAV2
+{
+
+/**
+ * @short A cookie jar that keeps the cookies of the servers in a file.
+ *
+ * Many servers hand out a session cookie that is much cheaper for them to
+ * verify than the credentials of the user. Set a jar on a session with
+ * DavSession::setCookieJar() to send those cookies back, also after a
+ * restart of the application if the jar is persisted.
+ *
+ * Session cookies, i.e. those without expiration date, are persisted as
+ * well, expired cookies are dropped when loading.
+ */
+class KPIMKDAV2_EXPORT DavCookieJar : public QNetworkCookieJar
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Creates a new cookie jar.
+     *
+     * @param fileName The file the cookies are loaded from right away and
+     *                 saved to shortly after they change, and when the jar
+     *                 is destroyed. If empty, the cookies are kept in
+     *                 memory only.
+     * @param parent The parent object.
+     */
+    explicit DavCookieJar(const QString &fileName = QString(), QObject *parent = nullptr);
+    ~DavCookieJar();
+
+    /**
+     * Returns the file the cookies are stored in.
+     */
+    QString fileName() const;
+
+    /**
+     * Replaces the cookies of the jar with those stored in the file.
+     */
+    bool load();
+
+    /**
+     * Writes the cookies of the jar to the file.
+     */
+    bool save() const;
+
+    /**
+     * Removes all the cookies, from the file as well.
+     */
+    void clear();
+
+    bool setCookiesFromUrl(const QList<QNetworkCookie> &cookieList, const QUrl &url) Q_DECL_OVERRIDE;
+    bool deleteCookie(const QNetworkCookie &cookie) Q_DECL_OVERRIDE;
+
+private:
+    void scheduleSave();
+
+    QString mFileName;
+    QTimer mSaveTimer;
+};
+
+}
+
+#endif
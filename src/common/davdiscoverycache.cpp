@@ -0,0 +1,168 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#include "davdiscoverycache.h"
+
+#include "davsession.h"
+#include "davurl.h"
+#include "libkdav2_debug.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QUrl>
+
+using namespace KDAV2;
+
+// Bump whenever the format of the files changes, older files are ignored then
+static const quint32 cacheFormatVersion = 2;
+
+// Different accounts on the same server have different principals
+static QString account(const DavUrl &url, const DavSession *session)
+{
+    if (!url.url().userName().isEmpty()) {
+        return url.url().userName();
+    }
+    if (session && !session->userName().isEmpty()) {
+        return session->userName();
+    }
+    if (session && !session->bearerToken().isEmpty()) {
+        // The key is stored in the file, the token must not
+        const QByteArray hash = QCryptographicHash::hash(session->bearerToken().toUtf8(), QCryptographicHash::Sha1);
+        return QStringLiteral("bearer:") + QString::fromLatin1(hash.toHex());
+    }
+    return QString();
+}
+
+static QString cacheKey(const DavUrl &url, const DavSession *session)
+{
+    return QString::number(url.protocol()) + QLatin1Char(' ') + account(url, session) + QLatin1Char(' ')
+           + url.url().adjusted(QUrl::RemoveUserInfo | QUrl::RemoveFragment).toString();
+}
+
+DavDiscoveryCache::DavDiscoveryCache(const QString &directory)
+    : mDirectory(directory)
+    , mTimeToLive(24 * 60 * 60)
+{
+    if (mDirectory.isEmpty()) {
+        mDirectory = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/kdav2/discovery");
+    }
+}
+
+QString DavDiscoveryCache::directory() const
+{
+    return mDirectory;
+}
+
+void DavDiscoveryCache::setTimeToLive(qint64 seconds)
+{
+    mTimeToLive = qMax<qint64>(0, seconds);
+}
+
+qint64 DavDiscoveryCache::timeToLive() const
+{
+    return mTimeToLive;
+}
+
+QString DavDiscoveryCache::filePath(const QString &key) const
+{
+    const QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1);
+    return mDirectory + QLatin1Char('/') + QString::fromLatin1(hash.toHex());
+}
+
+DavDiscoveryCache::LookupResult DavDiscoveryCache::lookup(const DavUrl &url, QUrl &principalUrl, QStringList &homeSets, const DavSession *session) const
+{
+    const QString expectedKey = cacheKey(url, session);
+    QFile file(filePath(expectedKey));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return NotFound;
+    }
+
+    QDataStream stream(&file);
+    quint32 version = 0;
+    stream >> version;
+    if (version != cacheFormatVersion) {
+        return NotFound;
+    }
+
+    QString key;
+    QUrl cachedPrincipalUrl;
+    QStringList cachedHomeSets;
+    QDateTime storedAt;
+    stream >> key >> cachedPrincipalUrl >> cachedHomeSets >> storedAt;
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(KDAV2_LOG) << "Ignoring corrupted discovery cache file" << file.fileName();
+        return NotFound;
+    }
+
+    // Guard against hash collisions
+    if (key != expectedKey || !cachedPrincipalUrl.isValid()) {
+        return NotFound;
+    }
+
+    principalUrl = cachedPrincipalUrl;
+    principalUrl.setUserName(url.url().userName());
+    principalUrl.setPassword(url.url().password());
+    homeSets = cachedHomeSets;
+
+    if (storedAt.secsTo(QDateTime::currentDateTimeUtc()) > mTimeToLive) {
+        return Stale;
+    }
+    return Fresh;
+}
+
+void DavDiscoveryCache::insert(const DavUrl &url, const QUrl &principalUrl, const QStringList &homeSets, const DavSession *session)
+{
+    if (!QDir().mkpath(mDirectory)) {
+        qCWarning(KDAV2_LOG) << "Failed to create the discovery cache directory" << mDirectory;
+        return;
+    }
+    // The entries tell which accounts the user has, only the user may read them
+    QFile::setPermissions(mDirectory, QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner);
+
+    const QString key = cacheKey(url, session);
+    QSaveFile file(filePath(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(KDAV2_LOG) << "Failed to write the discovery cache file" << file.fileName() << file.errorString();
+        return;
+    }
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+
+    QDataStream stream(&file);
+    stream << cacheFormatVersion;
+    stream << key << principalUrl.adjusted(QUrl::RemoveUserInfo) << homeSets << QDateTime::currentDateTimeUtc();
+
+    if (!file.commit()) {
+        qCWarning(KDAV2_LOG) << "Failed to write the discovery cache file" << file.fileName() << file.errorString();
+    }
+}
+
+void DavDiscoveryCache::remove(const DavUrl &url, const DavSession *session)
+{
+    QFile::remove(filePath(cacheKey(url, session)));
+}
+
+void DavDiscoveryCache::clear()
+{
+    QDir(mDirectory).removeRecursively();
+}
@@ -0,0 +1,122 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef KDAV2_DAVDISCOVERYCACHE_H
+#define KDAV2_DAVDISCOVERYCACHE_H
+
+#include "kpimkdav2_export.h"
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+class QUrl;
+
+namespace KDAV2
+{
+
+class DavSession;
+class DavUrl;
+
+/**
+ * @short A persistent cache of the principal urls and home sets of accounts.
+ *
+ * If a cache is set on the session, DavDiscoveryJob and
+ * DavPrincipalHomeSetsFetchJob answer from it instead of asking the server.
+ * Entries older than timeToLive() are still used, but the jobs fetch them
+ * again in the background to update the cache. Entries are removed when
+ * the server answers 403 or 404 for the principal or a home set.
+ *
+ * The entries are stored in one file per url and account in a directory.
+ * The account is identified by the user name of the url, or else by the
+ * credentials or the bearer token of the session the url is used with.
+ *
+ * @see DavSession::setDiscoveryCache()
+ */
+class KPIMKDAV2_EXPORT DavDiscoveryCache
+{
+public:
+    enum LookupResult {
+        NotFound = 0, ///< Nothing is known about the url
+        Fresh,        ///< The entry can be used as it is
+        Stale         ///< The entry can be used, but should be fetched again
+    };
+
+    /**
+     * Creates a new discovery cache.
+     *
+     * @param directory The directory the entries are stored in, it is
+     *                  created on demand. Defaults to a "kdav2/discovery"
+     *                  directory in the generic cache location of the user.
+     */
+    explicit DavDiscoveryCache(const QString &directory = QString());
+
+    /**
+     * Returns the directory the entries are stored in.
+     */
+    QString directory() const;
+
+    /**
+     * Sets the time in seconds after which an entry becomes stale.
+     * The default is one day.
+     */
+    void setTimeToLive(qint64 seconds);
+
+    /**
+     * Returns the time in seconds after which an entry becomes stale.
+     */
+    qint64 timeToLive() const;
+
+    /**
+     * Looks up what has been discovered for @p url.
+     *
+     * @param url The url given to a discovery job, its user name is part
+     *            of the key, and its user info is added to @p principalUrl.
+     * @param principalUrl Filled with the url of the principal.
+     * @param homeSets Filled with the home sets of the principal, if known.
+     * @param session The session the url is used with, it identifies the
+     *                account if the url has no user name.
+     */
+    LookupResult lookup(const DavUrl &url, QUrl &principalUrl, QStringList &homeSets, const DavSession *session = nullptr) const;
+
+    /**
+     * Stores the @p principalUrl and @p homeSets discovered for @p url
+     * with @p session.
+     */
+    void insert(const DavUrl &url, const QUrl &principalUrl, const QStringList &homeSets = QStringList(), const DavSession *session = nullptr);
+
+    /**
+     * Removes the entry of @p url with @p session, if any.
+     */
+    void remove(const DavUrl &url, const DavSession *session = nullptr);
+
+    /**
+     * Removes all the entries.
+     */
+    void clear();
+
+private:
+    QString filePath(const QString &key) const;
+
+    QString mDirectory;
+    qint64 mTimeToLive;
+};
+
+}
+
+#endif
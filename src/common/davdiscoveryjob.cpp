@@ -19,25 +19,145 @@
 #include "davdiscoveryjob.h"
 
 #include "libkdav2_debug.h"
-#include "davmanager.h"
+#include "davdiscoverycache.h"
+#include "davsession.h"
 #include "davprotocolbase.h"
 #include "daverror.h"
 #include "utils.h"
 #include "davjob.h"
 
+#include <algorithm>
+
 using namespace KDAV2;
 
+/**
+ * Returns the href of the principal named in the PROPFIND response
+ * @p document, or an empty string if there is none.
+ */
+static QString principalHref(const QDomDocument &document)
+{
+    const QDomElement multistatusElement = document.documentElement();
+
+    QDomElement responseElement = Utils::firstChildElementNS(multistatusElement, QStringLiteral("DAV:"), QStringLiteral("response"));
+    while (!responseElement.isNull()) {
+
+        const QDomElement propstatElement = [&] {
+            // check for the valid propstat, without giving up on first error
+            const QDomNodeList propstats = responseElement.elementsByTagNameNS(QStringLiteral("DAV:"), QStringLiteral("propstat"));
+            for (int i = 0; i < propstats.length(); ++i) {
+                const QDomElement propstatCandidate = propstats.item(i).toElement();
+                const QDomElement statusElement = Utils::firstChildElementNS(propstatCandidate, QStringLiteral("DAV:"), QStringLiteral("status"));
+                if (statusElement.text().contains(QLatin1String("200"))) {
+                    return propstatCandidate;
+                }
+            }
+            return QDomElement{};
+        }();
+
+        if (propstatElement.isNull()) {
+            responseElement = Utils::nextSiblingElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
+            continue;
+        }
+
+        // extract home sets
+        const QDomElement propElement = Utils::firstChildElementNS(propstatElement, QStringLiteral("DAV:"), QStringLiteral("prop"));
+
+        // Trying to get the principal url, given either by current-user-principal or principal-URL
+        QDomElement urlHolder = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("current-user-principal"));
+        if (urlHolder.isNull()) {
+            urlHolder = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("principal-URL"));
+        }
+
+        if (!urlHolder.isNull()) {
+            // Getting the href that will be used for the next round
+            const QDomElement hrefElement = Utils::firstChildElementNS(urlHolder, QStringLiteral("DAV:"), QStringLiteral("href"));
+            if (!hrefElement.isNull()) {
+                return hrefElement.text();
+            }
+        }
+
+        responseElement = Utils::nextSiblingElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
+    }
+    return QString{};
+}
+
 DavDiscoveryJob::DavDiscoveryJob(const DavUrl &davUrl, const QString &wellKnownSuffix, QObject *parent)
-    : DavJobBase(parent), mUrl(davUrl)
+    : DavJobBase(parent), mRevalidating(false), mParallel(false), mUrl(davUrl)
 {
     auto url = davUrl.url();
     if (!url.toString().contains("/.well-known/")) {
         url.setPath(url.path() + "/.well-known/" + wellKnownSuffix);
         mUrl.setUrl(url);
     }
+    mRequestedUrl = mUrl;
+}
+
+void DavDiscoveryJob::setParallelDiscovery(bool parallel)
+{
+    mParallel = parallel;
+}
+
+bool DavDiscoveryJob::parallelDiscovery() const
+{
+    return mParallel;
+}
+
+void DavDiscoveryJob::setFallbackPaths(const QStringList &paths)
+{
+    mFallbackPaths = paths;
+}
+
+QStringList DavDiscoveryJob::fallbackPaths() const
+{
+    return mFallbackPaths;
 }
 
 void DavDiscoveryJob::start()
+{
+    DavDiscoveryCache *cache = session()->discoveryCache();
+    if (cache && !mRevalidating && mUrl.url() == mRequestedUrl.url()) {
+        QUrl principalUrl;
+        QStringList homeSets;
+        const auto result = cache->lookup(mRequestedUrl, principalUrl, homeSets, session());
+        if (result != DavDiscoveryCache::NotFound) {
+            if (result == DavDiscoveryCache::Stale) {
+                revalidate();
+            }
+            mUrl.setUrl(principalUrl);
+            emitResult();
+            return;
+        }
+    }
+
+    // An earlier job of the session may have found the principal already
+    const QUrl principalUrl = mRevalidating ? QUrl() : session()->principalUrl(mRequestedUrl.url());
+    if (principalUrl.isValid() && mUrl.url() == mRequestedUrl.url()) {
+        mUrl.setUrl(principalUrl);
+        emitResult();
+        return;
+    }
+
+    if (mParallel) {
+        mRememberedPath = session()->discoveryPath(mRequestedUrl.url());
+        if (!mRememberedPath.isEmpty()) {
+            startCandidates(QStringList() << mRememberedPath);
+        } else {
+            startCandidates(candidatePaths());
+        }
+        return;
+    }
+
+    DavJob *job = createPropFindJob(mUrl.url());
+    connect(job, &DavJob::result, this, &DavDiscoveryJob::davJobFinished);
+}
+
+bool DavDiscoveryJob::doKill()
+{
+    abortCandidates();
+    return DavJobBase::doKill();
+}
+
+DavJob *DavDiscoveryJob::createPropFindJob(const QUrl &url)
 {
     QDomDocument document;
 
@@ -50,8 +170,54 @@ void DavDiscoveryJob::start()
     propElement.appendChild(document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("current-user-principal")));
     propElement.appendChild(document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("principal-URL")));
 
-    DavJob *job = DavManager::self()->createPropFindJob(mUrl.url(), document, QStringLiteral("0"));
-    connect(job, &DavJob::result, this, &DavDiscoveryJob::davJobFinished);
+    DavJob *job = session()->createPropFindJob(url, document, QStringLiteral("0"));
+    prepareJob(job);
+    return job;
+}
+
+QStringList DavDiscoveryJob::candidatePaths() const
+{
+    QStringList paths;
+    paths << mRequestedUrl.url().path() << QStringLiteral("/") << mFallbackPaths;
+    paths.removeDuplicates();
+    return paths;
+}
+
+void DavDiscoveryJob::startCandidates(const QStringList &paths)
+{
+    mCandidateError = Error();
+    for (const QString &path : paths) {
+        QUrl url = mRequestedUrl.url();
+        url.setPath(path);
+
+        Candidate candidate;
+        candidate.url = url;
+        candidate.job = createPropFindJob(url);
+        connect(candidate.job.data(), &DavJob::result, this, &DavDiscoveryJob::candidateJobFinished);
+        mCandidates << candidate;
+    }
+}
+
+void DavDiscoveryJob::abortCandidates()
+{
+    const auto candidates = mCandidates;
+    mCandidates.clear();
+    for (const Candidate &candidate : candidates) {
+        if (candidate.job) {
+            candidate.job->kill(KJob::Quietly);
+        }
+    }
+}
+
+void DavDiscoveryJob::revalidate()
+{
+    auto job = new DavDiscoveryJob(mRequestedUrl, QString());
+    job->mRevalidating = true;
+    job->setParallelDiscovery(mParallel);
+    job->setFallbackPaths(mFallbackPaths);
+    job->setSession(session());
+    job->setPriority(BackgroundPriority);
+    job->start();
 }
 
 QUrl DavDiscoveryJob::url() const
@@ -59,6 +225,44 @@ QUrl DavDiscoveryJob::url() const
     return mUrl.url();
 }
 
+QUrl DavDiscoveryJob::principalUrl(const QUrl &requestUrl, const QString &principalHref) const
+{
+    QUrl principalUrl(requestUrl);
+
+    if (principalHref.startsWith(QLatin1Char('/'))) {
+        // principalHref is only a path, use request url to complete
+        principalUrl.setPath(principalHref, QUrl::TolerantMode);
+    } else {
+        // href is a complete url
+        principalUrl = QUrl::fromUserInput(principalHref);
+        principalUrl.setUserName(requestUrl.userName());
+        principalUrl.setPassword(requestUrl.password());
+    }
+    return principalUrl;
+}
+
+void DavDiscoveryJob::recordRedirect(const QUrl &requestUrl, DavJob *job)
+{
+    // Later discoveries go to where the well-known url led right away
+    if (job->url() != requestUrl.adjusted(QUrl::RemoveUserInfo)) {
+        session()->addRedirect(requestUrl, job->url());
+    }
+}
+
+void DavDiscoveryJob::finishJob(const QUrl &principalUrl)
+{
+    mUrl.setUrl(principalUrl);
+    if (DavDiscoveryCache *cache = session()->discoveryCache()) {
+        cache->insert(mRequestedUrl, principalUrl, QStringList(), session());
+    }
+    // Let the home sets jobs go to the principal right away
+    if (principalUrl.isValid()) {
+        session()->setPrincipalUrl(mRequestedUrl.url(), principalUrl);
+        session()->setPrincipalUrl(principalUrl, principalUrl);
+    }
+    emitResult();
+}
+
 void DavDiscoveryJob::davJobFinished(KJob *job)
 {
     DavJob *davJob = static_cast<DavJob*>(job);
@@ -73,72 +277,74 @@ void DavDiscoveryJob::davJobFinished(KJob *job)
             start();
             return;
         }
+        DavDiscoveryCache *cache = session()->discoveryCache();
+        if (cache && (davJob->httpStatusCode() == 403 || davJob->httpStatusCode() == 404)) {
+            cache->remove(mRequestedUrl, session());
+        }
         setErrorFromJob(davJob);
         emitResult();
         return;
     }
-    mUrl.setUrl(davJob->url());
 
-    const QDomDocument document = davJob->response();
-    const QDomElement multistatusElement = document.documentElement();
-
-
-    const QString principalHref = [&] {
-        QDomElement responseElement = Utils::firstChildElementNS(multistatusElement, QStringLiteral("DAV:"), QStringLiteral("response"));
-        while (!responseElement.isNull()) {
-
-            const QDomElement propstatElement = [&] {
-                // check for the valid propstat, without giving up on first error
-                const QDomNodeList propstats = responseElement.elementsByTagNameNS(QStringLiteral("DAV:"), QStringLiteral("propstat"));
-                for (int i = 0; i < propstats.length(); ++i) {
-                    const QDomElement propstatCandidate = propstats.item(i).toElement();
-                    const QDomElement statusElement = Utils::firstChildElementNS(propstatCandidate, QStringLiteral("DAV:"), QStringLiteral("status"));
-                    if (statusElement.text().contains(QLatin1String("200"))) {
-                        return propstatCandidate;
-                    }
-                }
-                return QDomElement{};
-            }();
+    recordRedirect(mUrl.url(), davJob);
+    mUrl.setUrl(davJob->url());
 
-            if (propstatElement.isNull()) {
-                responseElement = Utils::nextSiblingElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
-                continue;
-            }
+    finishJob(principalUrl(mUrl.url(), principalHref(davJob->response())));
+}
 
-            // extract home sets
-            const QDomElement propElement = Utils::firstChildElementNS(propstatElement, QStringLiteral("DAV:"), QStringLiteral("prop"));
+void DavDiscoveryJob::candidateJobFinished(KJob *job)
+{
+    DavJob *davJob = static_cast<DavJob*>(job);
 
-            // Trying to get the principal url, given either by current-user-principal or principal-URL
-            QDomElement urlHolder = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("current-user-principal"));
-            if (urlHolder.isNull()) {
-                urlHolder = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("principal-URL"));
-            }
+    const auto it = std::find_if(mCandidates.begin(), mCandidates.end(), [davJob] (const Candidate &candidate) {
+        return candidate.job == davJob;
+    });
+    if (it == mCandidates.end()) {
+        // Aborted after another candidate won
+        return;
+    }
+    const Candidate candidate = *it;
+    mCandidates.erase(it);
 
-            if (!urlHolder.isNull()) {
-                // Getting the href that will be used for the next round
-                const QDomElement hrefElement = Utils::firstChildElementNS(urlHolder, QStringLiteral("DAV:"), QStringLiteral("href"));
-                if (!hrefElement.isNull()) {
-                    return hrefElement.text();
-                }
-            }
+    if (!davJob->error()) {
+        const QString href = principalHref(davJob->response());
+        if (!href.isEmpty()) {
+            abortCandidates();
+            recordRedirect(candidate.url, davJob);
+            session()->setDiscoveryPath(mRequestedUrl.url(), candidate.url.path());
+            qCDebug(KDAV2_LOG) << "Found the principal with" << candidate.url;
 
-            responseElement = Utils::nextSiblingElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
+            finishJob(principalUrl(davJob->url(), href));
+            return;
         }
-        return QString{};
-    }();
+    } else if (mCandidateError.errorNumber() == NO_ERR || candidate.url.path() == mRequestedUrl.url().path()) {
+        // Report the failure of the well-known url rather than the one of a fallback
+        mCandidateError = Error(ERR_PROBLEM_WITH_REQUEST, davJob->httpStatusCode(), davJob->responseCode(), davJob->errorText(), davJob->error());
+    }
 
-    QUrl principalUrl(mUrl.url());
+    if (!mCandidates.isEmpty()) {
+        return;
+    }
 
-    if (principalHref.startsWith(QLatin1Char('/'))) {
-        // principalHref is only a path, use request url to complete
-        principalUrl.setPath(principalHref, QUrl::TolerantMode);
-    } else {
-        // href is a complete url
-        principalUrl = QUrl::fromUserInput(principalHref);
-        principalUrl.setUserName(mUrl.url().userName());
-        principalUrl.setPassword(mUrl.url().password());
+    if (!mRememberedPath.isEmpty()) {
+        // What worked before doesn't anymore, ask all the candidates again
+        qCDebug(KDAV2_LOG) << "Discovery with" << mRememberedPath << "failed, trying all the candidates";
+        session()->setDiscoveryPath(mRequestedUrl.url(), QString());
+        mRememberedPath.clear();
+        startCandidates(candidatePaths());
+        return;
     }
 
-    mUrl.setUrl(principalUrl);
+    if (mCandidateError.errorNumber() == NO_ERR) {
+        // All the requests succeeded, but none named a principal
+        setError(ERR_PROBLEM_WITH_REQUEST);
+        setErrorTextFromDavError();
+    } else {
+        DavDiscoveryCache *cache = session()->discoveryCache();
+        if (cache && (mCandidateError.httpStatusCode() == 403 || mCandidateError.httpStatusCode() == 404)) {
+            cache->remove(mRequestedUrl, session());
+        }
+        setDavError(mCandidateError);
+    }
     emitResult();
 }
@@ -19,16 +19,21 @@
 
 #include "kpimkdav2_export.h"
 
+#include "daverror.h"
 #include "davjobbase.h"
 #include "davurl.h"
 
 #include <KCoreAddons/KJob>
 
+#include <QtCore/QPointer>
 #include <QtCore/QStringList>
+#include <QtCore/QVector>
 
 namespace KDAV2
 {
 
+class DavJob;
+
 /**
  * @short A job that discovers the principal url using well-known uri's
  *
@@ -47,6 +52,36 @@ public:
      */
     explicit DavDiscoveryJob(const DavUrl &url, const QString &wellKnownSuffix, QObject *parent = nullptr);
 
+    /**
+     * Sets whether the well-known url, the root url and the fallback paths
+     * are asked at the same time instead of one after the other.
+     *
+     * The first answer that names a principal wins and the other requests
+     * are aborted. The path that won is remembered in the session, and the
+     * next discovery of the same url only asks that path. Disabled by
+     * default.
+     *
+     * @see DavSession::discoveryPath()
+     */
+    void setParallelDiscovery(bool parallel);
+
+    /**
+     * Returns whether the candidate urls are asked at the same time.
+     */
+    bool parallelDiscovery() const;
+
+    /**
+     * Sets additional @p paths on the server that are asked for the
+     * principal in parallel discovery, e.g. "/remote.php/dav" for servers
+     * that don't implement the well-known urls.
+     */
+    void setFallbackPaths(const QStringList &paths);
+
+    /**
+     * Returns the additional paths asked in parallel discovery.
+     */
+    QStringList fallbackPaths() const;
+
     /**
      * Starts the job.
      */
@@ -57,10 +92,43 @@ public:
      */
     QUrl url() const;
 
+protected:
+    bool doKill() Q_DECL_OVERRIDE;
+
 private Q_SLOTS:
     void davJobFinished(KJob *);
+    void candidateJobFinished(KJob *);
 
 private:
+    struct Candidate {
+        QPointer<DavJob> job;
+        QUrl url;
+    };
+
+    DavJob *createPropFindJob(const QUrl &url);
+    QStringList candidatePaths() const;
+    void startCandidates(const QStringList &paths);
+    void abortCandidates();
+    QUrl principalUrl(const QUrl &requestUrl, const QString &principalHref) const;
+    void recordRedirect(const QUrl &requestUrl, DavJob *job);
+    void finishJob(const QUrl &principalUrl);
+
+    /**
+     * Discovers the principal of the requested url again in the
+     * background, to update the discovery cache.
+     */
+    void revalidate();
+
+    // The well-known url, the key in the discovery cache
+    DavUrl mRequestedUrl;
+    bool mRevalidating;
+    bool mParallel;
+    QStringList mFallbackPaths;
+    // The requests of a parallel discovery
+    QVector<Candidate> mCandidates;
+    // The path of a candidate that is asked alone, because it won before
+    QString mRememberedPath;
+    Error mCandidateError;
     DavUrl mUrl;
 };
 
@@ -84,15 +84,13 @@ QString Error::description() const
             return QStringLiteral("Protocol for the collection does not support MULTIGET");
         case ERR_SERVER_UNRECOVERABLE:
             return QStringLiteral("The server encountered an error that prevented it from completing your request: %1 (%2)").arg(mErrorText).arg(mHttpStatusCode);
+        case ERR_TIMEOUT:
+            return QStringLiteral("The server did not answer in time");
         case ERR_COLLECTIONDELETE:
             return QStringLiteral("There was a problem with the request. The collection has not been deleted from the server.\n"
                             "%1 (%2).").arg(mErrorText).arg(mHttpStatusCode);
         case ERR_COLLECTIONFETCH:
             return QStringLiteral("Invalid responses from backend");
-        case ERR_COLLECTIONFETCH_XQUERY_SETFOCUS:
-            return QStringLiteral("Error setting focus for XQuery");
-        case ERR_COLLECTIONFETCH_XQUERY_INVALID:
-            return QStringLiteral("Invalid XQuery submitted by DAV implementation");
         case ERR_COLLECTIONMODIFY:
             return QStringLiteral("There was a problem with the request. The collection has not been modified on the server.\n"
                         "%1 (%2).").arg(mErrorText).arg(mHttpStatusCode);
@@ -107,6 +105,13 @@ QString Error::description() const
         }
         case ERR_COLLECTIONCREATE:
             return QStringLiteral("There was an error when creating the collection");
+        case ERR_COLLECTIONSYNC:
+            return QStringLiteral("There was a problem with the request. The changes of the collection could not be fetched.\n"
+                        "%1 (%2).").arg(mErrorText).arg(mHttpStatusCode);
+        case ERR_COLLECTIONSYNC_NOT_SUPPORTED:
+            return QStringLiteral("Protocol for the collection does not support sync-collection");
+        case ERR_COLLECTIONSYNC_INVALID_TOKEN:
+            return QStringLiteral("The sync token is no longer valid, the collection has to be listed again");
         case ERR_ITEMCREATE:
             return QStringLiteral("There was a problem with the request. The item has not been created on the server.\n"
                         "%1 (%2).").arg(mErrorText).arg(mHttpStatusCode);
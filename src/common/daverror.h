@@ -33,14 +33,16 @@ enum ErrorNumber {
    ERR_PROBLEM_WITH_REQUEST = KJob::UserDefinedError + 200,
    ERR_NO_MULTIGET,
    ERR_SERVER_UNRECOVERABLE,
+   ERR_TIMEOUT,
    ERR_COLLECTIONDELETE = ERR_PROBLEM_WITH_REQUEST + 10,
    ERR_COLLECTIONFETCH = ERR_PROBLEM_WITH_REQUEST  + 20,
-   ERR_COLLECTIONFETCH_XQUERY_SETFOCUS,
-   ERR_COLLECTIONFETCH_XQUERY_INVALID,
    ERR_COLLECTIONMODIFY = ERR_PROBLEM_WITH_REQUEST + 30,
    ERR_COLLECTIONMODIFY_NO_PROPERITES,
    ERR_COLLECTIONMODIFY_RESPONSE,
    ERR_COLLECTIONCREATE = ERR_PROBLEM_WITH_REQUEST + 40,
+   ERR_COLLECTIONSYNC = ERR_PROBLEM_WITH_REQUEST + 50,
+   ERR_COLLECTIONSYNC_NOT_SUPPORTED,
+   ERR_COLLECTIONSYNC_INVALID_TOKEN,
    ERR_ITEMCREATE = ERR_PROBLEM_WITH_REQUEST + 100,
    ERR_ITEMDELETE = ERR_PROBLEM_WITH_REQUEST + 110,
    ERR_ITEMMODIFY = ERR_PROBLEM_WITH_REQUEST + 120,
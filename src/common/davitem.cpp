@@ -22,37 +22,22 @@
 
 using namespace KDAV2;
 
-class DavItemPrivate
+class DavItemPrivate : public QSharedData
 {
 public:
-    DavItemPrivate(DavItem *qPtr) : q(qPtr) {}
-
-    void fillFrom(const DavItemPrivate &other);
-
-    DavItem *q;
-
     DavUrl mUrl;
     QString mContentType;
     QByteArray mData;
     QString mEtag;
 };
 
-void DavItemPrivate::fillFrom(const DavItemPrivate& other)
-{
-    mUrl = other.mUrl;
-    mContentType = other.mContentType;
-    mData = other.mData;
-    mEtag = other.mEtag;
-}
-
-
 DavItem::DavItem()
-    : d(std::unique_ptr<DavItemPrivate>(new DavItemPrivate(this)))
+    : d(new DavItemPrivate)
 {
 }
 
 DavItem::DavItem(const DavUrl &url, const QString &contentType, const QByteArray &data, const QString &etag)
-    : d(std::unique_ptr<DavItemPrivate>(new DavItemPrivate(this)))
+    : d(new DavItemPrivate)
 {
     d->mUrl = url;
     d->mContentType = contentType;
@@ -60,21 +45,15 @@ DavItem::DavItem(const DavUrl &url, const QString &contentType, const QByteArray
     d->mEtag = etag;
 }
 
-DavItem::DavItem(const DavItem &other)
-    : d(std::unique_ptr<DavItemPrivate>(new DavItemPrivate(this)))
-{
-    d->fillFrom(*other.d.get());
-}
+DavItem::DavItem(const DavItem &other) = default;
 
-DavItem &DavItem::operator=(const DavItem &other)
-{
-    d->fillFrom(*other.d.get());
-    return *this;
-}
+DavItem::DavItem(DavItem &&other) noexcept = default;
 
-DavItem::~DavItem()
-{
-}
+DavItem &DavItem::operator=(const DavItem &other) = default;
+
+DavItem &DavItem::operator=(DavItem &&other) noexcept = default;
+
+DavItem::~DavItem() = default;
 
 void DavItem::setUrl(const DavUrl &url)
 {
@@ -21,10 +21,10 @@
 
 #include "kpimkdav2_export.h"
 
-#include <memory>
 
 #include <QtCore/QByteArray>
 #include <QtCore/QDataStream>
+#include <QtCore/QSharedDataPointer>
 #include <QtCore/QString>
 #include <QtCore/QVector>
 
@@ -71,8 +71,15 @@ public:
      */
     DavItem(const DavUrl &url, const QString &contentType, const QByteArray &data, const QString &etag);
 
+    /**
+     * Creates a shallow copy of @p other.
+     *
+     * The data is implicitly shared and only detached on the first write.
+     */
     DavItem(const DavItem &other);
+    DavItem(DavItem &&other) noexcept;
     DavItem &operator=(const DavItem &other);
+    DavItem &operator=(DavItem &&other) noexcept;
 
     ~DavItem();
 
@@ -117,7 +124,7 @@ public:
     QString etag() const;
 
 private:
-    std::unique_ptr<DavItemPrivate> d;
+    QSharedDataPointer<DavItemPrivate> d;
 };
 
 KPIMKDAV2_EXPORT QDataStream &operator<<(QDataStream &out, const DavItem &item);
@@ -0,0 +1,72 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef KDAV2_DAVITEMCACHE_H
+#define KDAV2_DAVITEMCACHE_H
+
+#include "kpimkdav2_export.h"
+
+class QUrl;
+
+namespace KDAV2
+{
+
+class DavItem;
+
+/**
+ * @short Interface of a local cache of DAV item bodies.
+ *
+ * If a cache is set on the session, DavItemFetchJob sends the etag of the
+ * cached copy of an item along with the request, and uses the cached body
+ * if the server answers that the item has not been modified since.
+ *
+ * Implementations don't need to validate the entries themselves, this is
+ * done by the server on each fetch.
+ *
+ * @see DavSession::setItemCache(), DavItemDiskCache
+ */
+class KPIMKDAV2_EXPORT DavItemCache
+{
+public:
+    virtual ~DavItemCache();
+
+    /**
+     * Looks up the cached copy of the item identified by @p url.
+     *
+     * @param url The url of the item, the user info is not part of the key.
+     * @param item Filled with the cached item if there is one.
+     * @return Whether a cached copy with an etag was found.
+     */
+    virtual bool lookup(const QUrl &url, DavItem &item) = 0;
+
+    /**
+     * Stores the data, content type and etag of @p item, replacing any
+     * previously cached copy.
+     */
+    virtual void insert(const DavItem &item) = 0;
+
+    /**
+     * Removes the cached copy of the item identified by @p url, if any.
+     */
+    virtual void remove(const QUrl &url) = 0;
+};
+
+}
+
+#endif
@@ -18,10 +18,11 @@
 
 #include "davitemcreatejob.h"
 
-#include "davitemfetchjob.h"
-#include "davmanager.h"
+#include "davitemcache.h"
+#include "davsession.h"
 #include "daverror.h"
 #include "davjob.h"
+#include "utils.h"
 
 #include "libkdav2_debug.h"
 
@@ -34,7 +35,8 @@ DavItemCreateJob::DavItemCreateJob(const DavItem &item, QObject *parent)
 
 void DavItemCreateJob::start()
 {
-    auto job = DavManager::self()->createCreateJob(mItem.data(), itemUrl(), mItem.contentType().toLatin1());
+    auto job = session()->createCreateJob(mItem.data(), itemUrl(), mItem.contentType().toLatin1());
+    prepareJob(job);
     connect(job, &DavJob::result, this, &DavItemCreateJob::davJobFinished);
 }
 
@@ -60,16 +62,25 @@ void DavItemCreateJob::davJobFinished(KJob *job)
 
     mItem.setUrl(DavUrl(storedJob->url(), mItem.url().protocol()));
 
-    DavItemFetchJob *fetchJob = new DavItemFetchJob(mItem);
-    connect(fetchJob, &DavItemFetchJob::result, this, &DavItemCreateJob::itemRefreshed);
-    fetchJob->start();
+    if (Utils::isStrongETag(storedJob->getETagHeader())) {
+        mItem.setEtag(storedJob->getETagHeader());
+        if (DavItemCache *cache = session()->itemCache()) {
+            cache->insert(mItem);
+        }
+        emitResult();
+        return;
+    }
+
+    // Ask for the etag alone, there is no need to download the data again
+    auto etagJob = session()->createPropFindJob(itemUrl(), Utils::etagQuery(), QStringLiteral("0"));
+    prepareJob(etagJob);
+    connect(etagJob, &DavJob::result, this, &DavItemCreateJob::etagFetched);
 }
 
-void DavItemCreateJob::itemRefreshed(KJob *job)
+void DavItemCreateJob::etagFetched(KJob *job)
 {
     if (!job->error()) {
-        DavItemFetchJob *fetchJob = qobject_cast<DavItemFetchJob *>(job);
-        mItem.setEtag(fetchJob->item().etag());
+        mItem.setEtag(Utils::extractETag(static_cast<DavJob *>(job)->response()));
     }
     emitResult();
 }
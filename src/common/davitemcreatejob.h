@@ -59,7 +59,7 @@ public:
 
 private Q_SLOTS:
     void davJobFinished(KJob *);
-    void itemRefreshed(KJob *);
+    void etagFetched(KJob *);
 
 private:
     DavItem mItem;
@@ -18,8 +18,9 @@
 
 #include "davitemdeletejob.h"
 
+#include "davitemcache.h"
 #include "davitemfetchjob.h"
-#include "davmanager.h"
+#include "davsession.h"
 #include "daverror.h"
 #include "davjob.h"
 
@@ -32,7 +33,8 @@ DavItemDeleteJob::DavItemDeleteJob(const DavItem &item, QObject *parent)
 
 void DavItemDeleteJob::start()
 {
-    DavJob *job = DavManager::self()->createDeleteJob(mItem.url().url());
+    DavJob *job = session()->createDeleteJob(mItem.url().url());
+    prepareJob(job);
     connect(job, &DavJob::result, this, &DavItemDeleteJob::davJobFinished);
 }
 
@@ -58,10 +60,13 @@ void DavItemDeleteJob::davJobFinished(KJob *job)
 
         if (hasConflict()) {
             DavItemFetchJob *fetchJob = new DavItemFetchJob(mItem);
+            prepareJob(fetchJob);
             connect(fetchJob, &DavItemFetchJob::result, this, &DavItemDeleteJob::conflictingItemFetched);
             fetchJob->start();
             return;
         }
+    } else if (DavItemCache *cache = session()->itemCache()) {
+        cache->remove(mItem.url().url());
     }
 
     emitResult();
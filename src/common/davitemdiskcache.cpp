@@ -0,0 +1,134 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#include "davitemdiskcache.h"
+
+#include "davitem.h"
+#include "davurl.h"
+#include "libkdav2_debug.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QUrl>
+
+using namespace KDAV2;
+
+// Bump whenever the format of the files changes, older files are ignored then
+static const quint32 cacheFormatVersion = 1;
+
+static QUrl cacheKey(const QUrl &url)
+{
+    return url.adjusted(QUrl::RemoveUserInfo | QUrl::RemoveFragment);
+}
+
+DavItemDiskCache::DavItemDiskCache(const QString &directory)
+    : mDirectory(directory)
+{
+    if (mDirectory.isEmpty()) {
+        mDirectory = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/kdav2/items");
+    }
+}
+
+QString DavItemDiskCache::directory() const
+{
+    return mDirectory;
+}
+
+QString DavItemDiskCache::filePath(const QUrl &url) const
+{
+    const QByteArray hash = QCryptographicHash::hash(cacheKey(url).toEncoded(), QCryptographicHash::Sha1);
+    return mDirectory + QLatin1Char('/') + QString::fromLatin1(hash.toHex());
+}
+
+bool DavItemDiskCache::lookup(const QUrl &url, DavItem &item)
+{
+    QFile file(filePath(url));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 version = 0;
+    stream >> version;
+    if (version != cacheFormatVersion) {
+        return false;
+    }
+
+    DavItem cachedItem;
+    stream >> cachedItem;
+    if (stream.status() != QDataStream::Ok) {
+        qCWarning(KDAV2_LOG) << "Ignoring corrupted cache file" << file.fileName();
+        return false;
+    }
+
+    // Guard against hash collisions
+    if (cacheKey(cachedItem.url().url()) != cacheKey(url) || cachedItem.etag().isEmpty()) {
+        return false;
+    }
+
+    item = cachedItem;
+    return true;
+}
+
+void DavItemDiskCache::insert(const DavItem &item)
+{
+    const QUrl url = item.url().url();
+
+    // Without an etag the copy can never be validated
+    if (item.etag().isEmpty()) {
+        remove(url);
+        return;
+    }
+
+    if (!QDir().mkpath(mDirectory)) {
+        qCWarning(KDAV2_LOG) << "Failed to create the item cache directory" << mDirectory;
+        return;
+    }
+    // The items are private contacts and events, only the user may read them
+    QFile::setPermissions(mDirectory, QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner);
+
+    QSaveFile file(filePath(url));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(KDAV2_LOG) << "Failed to write the item cache file" << file.fileName() << file.errorString();
+        return;
+    }
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+
+    QDataStream stream(&file);
+    stream << cacheFormatVersion;
+    stream << DavItem(DavUrl(cacheKey(url), item.url().protocol()), item.contentType(), item.data(), item.etag());
+
+    if (!file.commit()) {
+        qCWarning(KDAV2_LOG) << "Failed to write the item cache file" << file.fileName() << file.errorString();
+    }
+}
+
+void DavItemDiskCache::remove(const QUrl &url)
+{
+    QFile::remove(filePath(url));
+}
+
+void DavItemDiskCache::clear()
+{
+    QDir(mDirectory).removeRecursively();
+}
@@ -0,0 +1,69 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef KDAV2_DAVITEMDISKCACHE_H
+#define KDAV2_DAVITEMDISKCACHE_H
+
+#include "kpimkdav2_export.h"
+
+#include "davitemcache.h"
+
+#include <QtCore/QString>
+
+namespace KDAV2
+{
+
+/**
+ * @short A DavItemCache that stores one file per item in a directory.
+ */
+class KPIMKDAV2_EXPORT DavItemDiskCache : public DavItemCache
+{
+public:
+    /**
+     * Creates a new disk cache.
+     *
+     * @param directory The directory the items are stored in, it is created
+     *                  on demand. Defaults to a "kdav2/items" directory in the
+     *                  generic cache location of the user.
+     */
+    explicit DavItemDiskCache(const QString &directory = QString());
+
+    /**
+     * Returns the directory the items are stored in.
+     */
+    QString directory() const;
+
+    bool lookup(const QUrl &url, DavItem &item) Q_DECL_OVERRIDE;
+    void insert(const DavItem &item) Q_DECL_OVERRIDE;
+    void remove(const QUrl &url) Q_DECL_OVERRIDE;
+
+    /**
+     * Removes all the cached items.
+     */
+    void clear();
+
+private:
+    QString filePath(const QUrl &url) const;
+
+    QString mDirectory;
+};
+
+}
+
+#endif
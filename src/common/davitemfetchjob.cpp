@@ -18,20 +18,31 @@
 
 #include "davitemfetchjob.h"
 
-#include "davmanager.h"
+#include "davitemcache.h"
+#include "davsession.h"
 #include "daverror.h"
 #include "davjob.h"
 
 using namespace KDAV2;
 
 DavItemFetchJob::DavItemFetchJob(const DavItem &item, QObject *parent)
-    : DavJobBase(parent), mItem(item)
+    : DavJobBase(parent), mItem(item), mHasCachedItem(false), mFromCache(false)
 {
+    setPriority(InteractivePriority);
 }
 
 void DavItemFetchJob::start()
 {
-    auto job = DavManager::self()->createGetJob(mItem.url().url());
+    QByteArray etag;
+    if (DavItemCache *cache = session()->itemCache()) {
+        mHasCachedItem = cache->lookup(mItem.url().url(), mCachedItem);
+        if (mHasCachedItem) {
+            etag = mCachedItem.etag().toUtf8();
+        }
+    }
+
+    auto job = session()->createGetJob(mItem.url().url(), etag);
+    prepareJob(job);
     connect(job, &DavJob::result, this, &DavItemFetchJob::davJobFinished);
 }
 
@@ -40,15 +51,30 @@ DavItem DavItemFetchJob::item() const
     return mItem;
 }
 
+bool DavItemFetchJob::isFromCache() const
+{
+    return mFromCache;
+}
+
 void DavItemFetchJob::davJobFinished(KJob *job)
 {
     auto *storedJob = static_cast<DavJob*>(job);
     if (storedJob->error()) {
         setErrorFromJob(storedJob);
+    } else if (storedJob->httpStatusCode() == 304 && mHasCachedItem) {
+        mFromCache = true;
+        mItem.setData(mCachedItem.data());
+        mItem.setContentType(mCachedItem.contentType());
+        const QString etag = storedJob->getETagHeader();
+        mItem.setEtag(etag.isEmpty() ? mCachedItem.etag() : etag);
     } else {
         mItem.setData(storedJob->data());
         mItem.setContentType(storedJob->getContentTypeHeader());
         mItem.setEtag(storedJob->getETagHeader());
+
+        if (DavItemCache *cache = session()->itemCache()) {
+            cache->insert(mItem);
+        }
     }
 
     emitResult();
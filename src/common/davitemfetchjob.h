@@ -30,6 +30,11 @@ namespace KDAV2
 
 /**
  * @short A job that fetches a DAV item from the DAV server.
+ *
+ * If the session has an item cache, the cached copy of the item is only
+ * downloaded again if it has been modified on the server.
+ *
+ * @see DavSession::setItemCache()
  */
 class KPIMKDAV2_EXPORT DavItemFetchJob : public DavJobBase
 {
@@ -54,12 +59,21 @@ public:
      */
     DavItem item() const;
 
+    /**
+     * Returns whether the server confirmed that the cached copy of the item
+     * is still current, so that item() has been served from the cache.
+     */
+    bool isFromCache() const;
+
 private Q_SLOTS:
     void davJobFinished(KJob *);
 
 private:
     DavUrl mUrl;
     DavItem mItem;
+    DavItem mCachedItem;
+    bool mHasCachedItem;
+    bool mFromCache;
 };
 
 }
@@ -18,10 +18,12 @@
 
 #include "davitemmodifyjob.h"
 
+#include "davitemcache.h"
 #include "davitemfetchjob.h"
-#include "davmanager.h"
+#include "davsession.h"
 #include "daverror.h"
 #include "davjob.h"
+#include "utils.h"
 
 using namespace KDAV2;
 
@@ -32,7 +34,8 @@ DavItemModifyJob::DavItemModifyJob(const DavItem &item, QObject *parent)
 
 void DavItemModifyJob::start()
 {
-    auto job = DavManager::self()->createModifyJob(mItem.data(), itemUrl(), mItem.contentType().toUtf8(), mItem.etag().toUtf8());
+    auto job = session()->createModifyJob(mItem.data(), itemUrl(), mItem.contentType().toUtf8(), mItem.etag().toUtf8());
+    prepareJob(job);
     connect(job, &DavJob::result, this, &DavItemModifyJob::davJobFinished);
 }
 
@@ -65,6 +68,7 @@ void DavItemModifyJob::davJobFinished(KJob *job)
 
         if (hasConflict()) {
             DavItemFetchJob *fetchJob = new DavItemFetchJob(mItem);
+            prepareJob(fetchJob);
             connect(fetchJob, &DavItemFetchJob::result, this, &DavItemModifyJob::conflictingItemFetched);
             fetchJob->start();
         } else {
@@ -88,16 +92,26 @@ void DavItemModifyJob::davJobFinished(KJob *job)
     url.setUserInfo(itemUrl().userInfo());
     mItem.setUrl(DavUrl(url, mItem.url().protocol()));
 
-    DavItemFetchJob *fetchJob = new DavItemFetchJob(mItem);
-    connect(fetchJob, &DavItemFetchJob::result, this, &DavItemModifyJob::itemRefreshed);
-    fetchJob->start();
+    if (Utils::isStrongETag(storedJob->getETagHeader())) {
+        mItem.setEtag(storedJob->getETagHeader());
+        if (DavItemCache *cache = session()->itemCache()) {
+            cache->insert(mItem);
+        }
+        emitResult();
+        return;
+    }
+
+    // Without a strong etag the server might have altered the data, so it
+    // can't be cached, but only the new etag is of interest here anyway
+    auto etagJob = session()->createPropFindJob(itemUrl(), Utils::etagQuery(), QStringLiteral("0"));
+    prepareJob(etagJob);
+    connect(etagJob, &DavJob::result, this, &DavItemModifyJob::etagFetched);
 }
 
-void DavItemModifyJob::itemRefreshed(KJob *job)
+void DavItemModifyJob::etagFetched(KJob *job)
 {
     if (!job->error()) {
-        DavItemFetchJob *fetchJob = qobject_cast<DavItemFetchJob *>(job);
-        mItem.setEtag(fetchJob->item().etag());
+        mItem.setEtag(Utils::extractETag(static_cast<DavJob *>(job)->response()));
     } else {
         mItem.setEtag(QString());
     }
@@ -68,7 +68,7 @@ public:
 
 private Q_SLOTS:
     void davJobFinished(KJob *);
-    void itemRefreshed(KJob *);
+    void etagFetched(KJob *);
     void conflictingItemFetched(KJob *);
 
 private:
@@ -20,6 +20,7 @@
 #include "davitemsfetchjob.h"
 
 #include "davmanager.h"
+#include "davsession.h"
 #include "davmultigetprotocol.h"
 #include "utils.h"
 #include "daverror.h"
@@ -29,7 +30,19 @@ using namespace KDAV2;
 
 DavItemsFetchJob::DavItemsFetchJob(const DavUrl &collectionUrl, const QStringList &urls, QObject *parent)
     : DavJobBase(parent), mCollectionUrl(collectionUrl), mUrls(urls)
+    , mBatchSize(100), mMaxConcurrentRequests(2), mNextUrl(0), mBatchSucceeded(false)
 {
+    setPriority(BackgroundPriority);
+}
+
+void DavItemsFetchJob::setBatchSize(int size)
+{
+    mBatchSize = qMax(1, size);
+}
+
+void DavItemsFetchJob::setMaxConcurrentRequests(int count)
+{
+    mMaxConcurrentRequests = qMax(1, count);
 }
 
 void DavItemsFetchJob::start()
@@ -50,9 +63,30 @@ void DavItemsFetchJob::start()
         return;
     }
 
-    const QDomDocument report = protocol->itemsReportQuery(mUrls)->buildQuery();
-    DavJob *job = DavManager::self()->createReportJob(mCollectionUrl.url(), report, QStringLiteral("0"));
-    connect(job, &DavJob::result, this, &DavItemsFetchJob::davJobFinished);
+    startRequests();
+}
+
+void DavItemsFetchJob::startRequests()
+{
+    const DavMultigetProtocol *protocol =
+        static_cast<const DavMultigetProtocol *>(DavManager::self()->davProtocol(mCollectionUrl.protocol()));
+
+    while (mBatches.size() < mMaxConcurrentRequests && mNextUrl < mUrls.size()) {
+        Batch batch;
+        batch.urls = mUrls.mid(mNextUrl, mBatchSize);
+        mNextUrl += batch.urls.size();
+
+        const QDomDocument report = protocol->itemsReportQuery(batch.urls)->buildQuery();
+        DavJob *job = session()->createReportJob(mCollectionUrl.url(), report, QStringLiteral("0"));
+        prepareJob(job);
+        mBatches.insert(job, batch);
+
+        job->setStreaming(true);
+        connect(job, &DavJob::responseParsed, this, [this, job] (const DavMultistatusResponse &response) {
+            processResponse(job, response);
+        });
+        connect(job, &DavJob::result, this, &DavItemsFetchJob::davJobFinished);
+    }
 }
 
 DavItem::List DavItemsFetchJob::items() const
@@ -70,84 +104,111 @@ DavItem DavItemsFetchJob::item(const QString &url) const
     return mItems.value(url);
 }
 
+QStringList DavItemsFetchJob::failedUrls() const
+{
+    return mFailedUrls;
+}
+
 void DavItemsFetchJob::davJobFinished(KJob *job)
 {
     auto davJob = static_cast<DavJob *>(job);
+    const Batch batch = mBatches.take(davJob);
+
     if (davJob->error()) {
-        setErrorFromJob(davJob);
-        emitResult();
-        return;
+        // Only this batch is lost, go on with the others
+        mBatchError = Error{ERR_PROBLEM_WITH_REQUEST, davJob->httpStatusCode(), davJob->responseCode(), davJob->errorText(), davJob->error()};
+    } else {
+        mBatchSucceeded = true;
     }
 
-    const DavMultigetProtocol *protocol =
-        static_cast<const DavMultigetProtocol *>(DavManager::self()->davProtocol(mCollectionUrl.protocol()));
-
-    const QDomDocument document = davJob->response();
-    const QDomElement documentElement = document.documentElement();
+    // The urls the server didn't answer for, all of them if the request failed early
+    for (const QString &url : batch.urls) {
+        if (!batch.answeredUrls.contains(url)) {
+            mFailedUrls << url;
+        }
+    }
 
-    QDomElement responseElement = Utils::firstChildElementNS(documentElement, QStringLiteral("DAV:"), QStringLiteral("response"));
+    if (!batch.items.isEmpty()) {
+        Q_EMIT itemsReceived(batch.items);
+    }
 
-    while (!responseElement.isNull()) {
-        QDomElement propstatElement = Utils::firstChildElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("propstat"));
+    startRequests();
 
-        if (propstatElement.isNull()) {
-            responseElement = Utils::nextSiblingElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
-            continue;
+    if (mBatches.isEmpty()) {
+        if (!mBatchSucceeded) {
+            setDavError(mBatchError);
         }
+        emitResult();
+    }
+}
 
-        // Check for errors
-        const QDomElement statusElement = Utils::firstChildElementNS(propstatElement, QStringLiteral("DAV:"), QStringLiteral("status"));
-        if (!statusElement.text().contains(QLatin1String("200"))) {
-            responseElement = Utils::nextSiblingElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
-            continue;
-        }
+void DavItemsFetchJob::processResponse(DavJob *davJob, const DavMultistatusResponse &response)
+{
+    const DavMultigetProtocol *protocol =
+        static_cast<const DavMultigetProtocol *>(DavManager::self()->davProtocol(mCollectionUrl.protocol()));
 
-        const QDomElement propElement = Utils::firstChildElementNS(propstatElement, QStringLiteral("DAV:"), QStringLiteral("prop"));
+    Batch &batch = mBatches[davJob];
 
-        DavItem item;
+    // extract path
+    const QString href = response.href();
 
-        // extract path
-        const QDomElement hrefElement = Utils::firstChildElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("href"));
-        const QString href = hrefElement.text();
+    QUrl url = davJob->url();
+    if (href.startsWith(QLatin1Char('/'))) {
+        // href is only a path, use request url to complete
+        url.setPath(href, QUrl::TolerantMode);
+    } else {
+        // href is a complete url
+        url = QUrl::fromUserInput(href);
+    }
 
-        QUrl url = davJob->url();
-        if (href.startsWith(QLatin1Char('/'))) {
-            // href is only a path, use request url to complete
-            url.setPath(href, QUrl::TolerantMode);
-        } else {
-            // href is a complete url
-            url = QUrl::fromUserInput(href);
+    // Find the requested url the response is for, to report it if it failed
+    QString requestedUrl = url.toDisplayString(QUrl::RemoveUserInfo);
+    for (const QString &batchUrl : batch.urls) {
+        if (QUrl(batchUrl).path() == url.path()) {
+            requestedUrl = batchUrl;
+            break;
         }
+    }
+    if (batch.answeredUrls.contains(requestedUrl)) {
+        return;
+    }
+    batch.answeredUrls.insert(requestedUrl);
 
-        auto _url = url;
-        _url.setUserInfo(mCollectionUrl.url().userInfo());
-        item.setUrl(DavUrl(_url, mCollectionUrl.protocol()));
+    const QDomElement responseElement = response.element();
+    const QDomElement propstatElement = Utils::firstChildElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("propstat"));
+
+    // Check for errors, e.g. a 404 status for the whole response
+    const QDomElement statusElement = Utils::firstChildElementNS(propstatElement, QStringLiteral("DAV:"), QStringLiteral("status"));
+    if (propstatElement.isNull() || !statusElement.text().contains(QLatin1String("200"))) {
+        mFailedUrls << requestedUrl;
+        return;
+    }
 
-        // extract etag
-        const QDomElement getetagElement = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("getetag"));
-        item.setEtag(getetagElement.text());
+    const QDomElement propElement = Utils::firstChildElementNS(propstatElement, QStringLiteral("DAV:"), QStringLiteral("prop"));
 
-        // extract content
-        const QDomElement dataElement = Utils::firstChildElementNS(propElement,
-                                        protocol->responseNamespace(),
-                                        protocol->dataTagName());
+    DavItem item;
 
-        if (dataElement.isNull()) {
-            responseElement = Utils::nextSiblingElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
-            continue;
-        }
+    auto _url = url;
+    _url.setUserInfo(mCollectionUrl.url().userInfo());
+    item.setUrl(DavUrl(_url, mCollectionUrl.protocol()));
 
-        const QByteArray data = dataElement.firstChild().toText().data().toUtf8();
-        if (data.isEmpty()) {
-            responseElement = Utils::nextSiblingElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
-            continue;
-        }
+    // extract etag
+    const QDomElement getetagElement = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("getetag"));
+    item.setEtag(getetagElement.text());
 
-        item.setData(data);
+    // extract content
+    const QDomElement dataElement = Utils::firstChildElementNS(propElement,
+                                    protocol->responseNamespace(),
+                                    protocol->dataTagName());
 
-        mItems.insert(item.url().toDisplayString(), item);
-        responseElement = Utils::nextSiblingElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
+    const QByteArray data = dataElement.firstChild().toText().data().toUtf8();
+    if (data.isEmpty()) {
+        mFailedUrls << requestedUrl;
+        return;
     }
 
-    emitResult();
+    item.setData(data);
+
+    mItems.insert(item.url().toDisplayString(), item);
+    batch.items << item;
 }
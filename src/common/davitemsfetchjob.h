@@ -26,14 +26,28 @@
 #include "davjobbase.h"
 #include "davurl.h"
 
+#include <QtCore/QHash>
 #include <QtCore/QMap>
+#include <QtCore/QSet>
 #include <QtCore/QStringList>
 
 namespace KDAV2
 {
 
+class DavJob;
+class DavMultistatusResponse;
+
 /**
  * @short A job that fetches a list of items from a DAV server using a multiget query.
+ *
+ * The urls are split into batches that are fetched with one multiget
+ * request each, a bounded number of them being sent at the same time.
+ * The items of every batch are announced with itemsReceived() as soon
+ * as the batch has been fetched.
+ *
+ * Urls that can't be fetched don't make the whole job fail, they are
+ * listed by failedUrls() instead. The job only fails if nothing could
+ * be fetched at all.
  */
 class KPIMKDAV2_EXPORT DavItemsFetchJob : public DavJobBase
 {
@@ -49,6 +63,20 @@ public:
      */
     DavItemsFetchJob(const DavUrl &collectionUrl, const QStringList &urls, QObject *parent = nullptr);
 
+    /**
+     * Sets the maximum number of urls fetched with a single request.
+     *
+     * Defaults to 100.
+     */
+    void setBatchSize(int size);
+
+    /**
+     * Sets the maximum number of requests sent at the same time.
+     *
+     * Defaults to 2.
+     */
+    void setMaxConcurrentRequests(int count);
+
     /**
      * Starts the job.
      */
@@ -64,13 +92,43 @@ public:
      */
     DavItem item(const QString &url) const;
 
+    /**
+     * Returns the urls that could not be fetched, either because the server
+     * reported an error for them or because the request for their batch failed.
+     */
+    QStringList failedUrls() const;
+
+Q_SIGNALS:
+    /**
+     * This signal is emitted every time a batch of items has been fetched.
+     *
+     * @param items The items of the batch
+     */
+    void itemsReceived(const KDAV2::DavItem::List &items);
+
 private Q_SLOTS:
     void davJobFinished(KJob *);
 
 private:
+    struct Batch {
+        QStringList urls;
+        DavItem::List items;
+        QSet<QString> answeredUrls;
+    };
+
+    void startRequests();
+    void processResponse(DavJob *job, const DavMultistatusResponse &response);
+
     DavUrl mCollectionUrl;
     QStringList mUrls;
     QMap<QString, DavItem> mItems;
+    QStringList mFailedUrls;
+    QHash<DavJob *, Batch> mBatches;
+    int mBatchSize;
+    int mMaxConcurrentRequests;
+    int mNextUrl;
+    bool mBatchSucceeded;
+    Error mBatchError;
 };
 
 }
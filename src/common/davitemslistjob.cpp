@@ -20,10 +20,12 @@
 
 #include "daverror.h"
 #include "davmanager.h"
+#include "davsession.h"
 #include "davprotocolbase.h"
 #include "davurl.h"
 #include "utils.h"
 #include "davjob.h"
+#include "libkdav2_debug.h"
 
 #include <QtCore/QBuffer>
 #include <QtCore/QDebug>
@@ -32,20 +34,28 @@ using namespace KDAV2;
 
 class DavItemsListJobPrivate {
 public:
-    DavItemsListJobPrivate(const DavUrl &url);
+    DavItemsListJobPrivate(const DavUrl &url, DavCollection::ContentTypes contentTypes = DavCollection::ContentTypes());
 
     DavUrl mUrl;
+    DavCollection::ContentTypes mContentTypes; // unknown if none
     QStringList mMimeTypes;
+    QStringList mListedMimeTypes; // the ones of mMimeTypes the protocol has a query for
     QString mRangeStart;
     QString mRangeEnd;
     DavItem::List mItems;
+    DavItem::List mDiscoveredItems; // not announced yet
     QSet<QString> mSeenUrls; // to prevent events duplication with some servers
     uint mSubJobCount;
+    bool mKeepItems;
+    bool mCombinedListing;
 };
 
-DavItemsListJobPrivate::DavItemsListJobPrivate(const DavUrl &url)
+DavItemsListJobPrivate::DavItemsListJobPrivate(const DavUrl &url, DavCollection::ContentTypes contentTypes)
     : mUrl(url)
+    , mContentTypes(contentTypes)
     , mSubJobCount(0)
+    , mKeepItems(true)
+    , mCombinedListing(true)
 {
 }
 
@@ -54,6 +64,14 @@ DavItemsListJob::DavItemsListJob(const DavUrl &url, QObject *parent)
     : DavJobBase(parent)
     , d(std::unique_ptr<DavItemsListJobPrivate>(new DavItemsListJobPrivate(url)))
 {
+    setPriority(BackgroundPriority);
+}
+
+DavItemsListJob::DavItemsListJob(const DavCollection &collection, QObject *parent)
+    : DavJobBase(parent)
+    , d(std::unique_ptr<DavItemsListJobPrivate>(new DavItemsListJobPrivate(collection.url(), collection.contentTypes())))
+{
+    setPriority(BackgroundPriority);
 }
 
 DavItemsListJob::~DavItemsListJob()
@@ -71,40 +89,111 @@ void DavItemsListJob::setTimeRange(const QString &start, const QString &end)
     d->mRangeEnd = end;
 }
 
+void DavItemsListJob::setKeepItems(bool keep)
+{
+    d->mKeepItems = keep;
+}
+
+void DavItemsListJob::setCombinedListing(bool combined)
+{
+    d->mCombinedListing = combined;
+}
+
 void DavItemsListJob::start()
 {
     const DavProtocolBase *protocol = DavManager::self()->davProtocol(d->mUrl.protocol());
     Q_ASSERT(protocol);
-    QVectorIterator<XMLQueryBuilder::Ptr> it(protocol->itemsQueries());
 
-    while (it.hasNext()) {
-        XMLQueryBuilder::Ptr builder = it.next();
-        if (!d->mRangeStart.isEmpty()) {
-            builder->setParameter(QStringLiteral("start"), d->mRangeStart);
-        }
-        if (!d->mRangeEnd.isEmpty()) {
-            builder->setParameter(QStringLiteral("end"), d->mRangeEnd);
-        }
+    QStringList collectionMimeTypes;
+    if (d->mContentTypes) {
+        collectionMimeTypes = protocol->itemsMimeTypes(d->mContentTypes);
+    }
 
-        const QDomDocument props = builder->buildQuery();
+    bool prunedByCollection = false;
+    for (const XMLQueryBuilder::Ptr &builder : protocol->itemsQueries()) {
         const QString mimeType = builder->mimeType();
-
-        if (d->mMimeTypes.isEmpty() || d->mMimeTypes.contains(mimeType)) {
-            ++d->mSubJobCount;
-            const auto url = d->mUrl.url();
-            auto job = protocol->useReport() ?
-                DavManager::self()->createReportJob(url, props) :
-                DavManager::self()->createPropFindJob(url, props);
-            job->setProperty("itemsMimeType", mimeType);
-            connect(job, &DavJob::result, this, &DavItemsListJob::davJobFinished);
+        if (!d->mMimeTypes.isEmpty() && !d->mMimeTypes.contains(mimeType)) {
+            continue;
         }
+        if (d->mContentTypes && !collectionMimeTypes.contains(mimeType)) {
+            prunedByCollection = true;
+            continue;
+        }
+        d->mListedMimeTypes << mimeType;
+    }
+
+    if (d->mListedMimeTypes.isEmpty() && prunedByCollection) {
+        // The collection can't contain any of the requested items
+        emitResult();
+        return;
     }
 
-    if (d->mSubJobCount == 0) {
+    if (d->mListedMimeTypes.isEmpty()) {
         setError(ERR_ITEMLIST_NOMIMETYPE);
         setErrorTextFromDavError();
         emitResult();
+        return;
+    }
+
+    XMLQueryBuilder::Ptr builder;
+    if (d->mCombinedListing && d->mListedMimeTypes.size() > 1) {
+        builder = protocol->combinedItemsQuery();
+    }
+
+    if (builder.isNull()) {
+        startPerTypeQueries();
+        return;
+    }
+
+    builder->setParameter(QStringLiteral("mimeTypes"), d->mListedMimeTypes);
+    if (!d->mRangeStart.isEmpty()) {
+        builder->setParameter(QStringLiteral("start"), d->mRangeStart);
     }
+    if (!d->mRangeEnd.isEmpty()) {
+        builder->setParameter(QStringLiteral("end"), d->mRangeEnd);
+    }
+
+    startQuery(builder->buildQuery(), QString(), true);
+}
+
+void DavItemsListJob::startPerTypeQueries()
+{
+    const DavProtocolBase *protocol = DavManager::self()->davProtocol(d->mUrl.protocol());
+
+    for (const XMLQueryBuilder::Ptr &builder : protocol->itemsQueries()) {
+        if (!d->mListedMimeTypes.contains(builder->mimeType())) {
+            continue;
+        }
+
+        if (!d->mRangeStart.isEmpty()) {
+            builder->setParameter(QStringLiteral("start"), d->mRangeStart);
+        }
+        if (!d->mRangeEnd.isEmpty()) {
+            builder->setParameter(QStringLiteral("end"), d->mRangeEnd);
+        }
+
+        startQuery(builder->buildQuery(), builder->mimeType(), false);
+    }
+}
+
+void DavItemsListJob::startQuery(const QDomDocument &query, const QString &mimeType, bool combined)
+{
+    const DavProtocolBase *protocol = DavManager::self()->davProtocol(d->mUrl.protocol());
+
+    ++d->mSubJobCount;
+    const auto url = d->mUrl.url();
+    auto job = protocol->useReport() ?
+        session()->createReportJob(url, query) :
+        session()->createPropFindJob(url, query);
+    prepareJob(job);
+    job->setProperty("itemsMimeType", mimeType);
+    job->setProperty("combinedListing", combined);
+    job->setStreaming(true);
+    connect(job, &DavJob::responseParsed, this, [this, job] (const DavMultistatusResponse &response) {
+        processResponse(job, response);
+    });
+    connect(job, &DavJob::responsesParsed, this, &DavItemsListJob::flushDiscoveredItems);
+    connect(job, &DavJob::result, this, &DavItemsListJob::davJobFinished);
 }
 
 DavItem::List DavItemsListJob::items() const
@@ -114,111 +203,29 @@ DavItem::List DavItemsListJob::items() const
 
 void DavItemsListJob::davJobFinished(KJob *job)
 {
+    flushDiscoveredItems();
+
     auto davJob = static_cast<DavJob*>(job);
     if (davJob->error()) {
-        setErrorFromJob(davJob);
-    } else {
-        /*
-         * Extract data from a document like the following:
-         *
-         * <multistatus xmlns="DAV:">
-         *   <response xmlns="DAV:">
-         *     <href xmlns="DAV:">/caldav.php/test1.user/home/KOrganizer-166749289.780.ics</href>
-         *     <propstat xmlns="DAV:">
-         *       <prop xmlns="DAV:">
-         *         <getetag xmlns="DAV:">"b4bbea0278f4f63854c4167a7656024a"</getetag>
-         *       </prop>
-         *       <status xmlns="DAV:">HTTP/1.1 200 OK</status>
-         *     </propstat>
-         *   </response>
-         *   <response xmlns="DAV:">
-         *     <href xmlns="DAV:">/caldav.php/test1.user/home/KOrganizer-399416366.464.ics</href>
-         *     <propstat xmlns="DAV:">
-         *       <prop xmlns="DAV:">
-         *         <getetag xmlns="DAV:">"52eb129018398a7da4f435b2bc4c6cd5"</getetag>
-         *       </prop>
-         *       <status xmlns="DAV:">HTTP/1.1 200 OK</status>
-         *     </propstat>
-         *   </response>
-         * </multistatus>
-         */
-
-        const QString itemsMimeType = job->property("itemsMimeType").toString();
-        const QDomDocument document = davJob->response();
-        const QDomElement documentElement = document.documentElement();
-
-        QDomElement responseElement = Utils::firstChildElementNS(documentElement, QStringLiteral("DAV:"), QStringLiteral("response"));
-        while (!responseElement.isNull()) {
-
-            QDomElement propstatElement;
-
-            // check for the valid propstat, without giving up on first error
-            {
-                const QDomNodeList propstats = responseElement.elementsByTagNameNS(QStringLiteral("DAV:"), QStringLiteral("propstat"));
-                for (int i = 0; i < propstats.length(); ++i) {
-                    const QDomElement propstatCandidate = propstats.item(i).toElement();
-                    const QDomElement statusElement = Utils::firstChildElementNS(propstatCandidate, QStringLiteral("DAV:"), QStringLiteral("status"));
-                    if (statusElement.text().contains(QStringLiteral("200"))) {
-                        propstatElement = propstatCandidate;
-                    }
-                }
-            }
-
-            if (propstatElement.isNull()) {
-                responseElement = Utils::nextSiblingElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
-                continue;
-            }
-
-            const QDomElement propElement = Utils::firstChildElementNS(propstatElement, QStringLiteral("DAV:"), QStringLiteral("prop"));
-
-            // check whether it is a dav collection ...
-            const QDomElement resourcetypeElement = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("resourcetype"));
-            if (!responseElement.isNull()) {
-                const QDomElement collectionElement = Utils::firstChildElementNS(resourcetypeElement, QStringLiteral("DAV:"), QStringLiteral("collection"));
-                if (!collectionElement.isNull()) {
-                    responseElement = Utils::nextSiblingElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
-                    continue;
-                }
-            }
-
-            // ... if not it is an item
-            DavItem item;
-            item.setContentType(itemsMimeType);
-
-            // extract path
-            const QDomElement hrefElement = Utils::firstChildElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("href"));
-            const QString href = hrefElement.text();
-
-            QUrl url = davJob->url();
-            url.setUserInfo(QString());
-            if (href.startsWith(QLatin1Char('/'))) {
-                // href is only a path, use request url to complete
-                url.setPath(href, QUrl::TolerantMode);
-            } else {
-                // href is a complete url
-                url = QUrl::fromUserInput(href);
-            }
-
-            QString itemUrl = url.toDisplayString();
-            if (d->mSeenUrls.contains(itemUrl)) {
-                responseElement = Utils::nextSiblingElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
-                continue;
-            }
-
-            d->mSeenUrls << itemUrl;
-            auto _url = url;
-            _url.setUserInfo(d->mUrl.url().userInfo());
-            item.setUrl(DavUrl(_url, d->mUrl.protocol()));
-
-            // extract etag
-            const QDomElement getetagElement = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("getetag"));
-
-            item.setEtag(getetagElement.text());
-
-            d->mItems << item;
-
-            responseElement = Utils::nextSiblingElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
+        const int responseCode = davJob->httpStatusCode();
+        // A 403 means the filter was rejected only if it comes with the
+        // precondition (RFC 4791, section 7.7), else it is about access
+        const QDomElement errorElement = davJob->response().documentElement();
+        const bool filterPreconditionFailed = errorElement.namespaceURI() == QLatin1String("DAV:")
+            && errorElement.localName() == QLatin1String("error")
+            && (!Utils::firstChildElementNS(errorElement, QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("supported-filter")).isNull()
+                || !Utils::firstChildElementNS(errorElement, QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("valid-filter")).isNull());
+        const bool filterRejected = responseCode == 400 || responseCode == 415 || responseCode == 422
+                                    || responseCode == 501 || filterPreconditionFailed;
+        if (davJob->property("combinedListing").toBool() && filterRejected) {
+            // The server doesn't understand the combined filter, ask for each type on its own
+            qCDebug(KDAV2_LOG) << "Combined listing rejected with" << responseCode << ", falling back to one query per type";
+            --d->mSubJobCount;
+            startPerTypeQueries();
+            return;
         }
+
+        setErrorFromJob(davJob);
     }
 
     if (--d->mSubJobCount == 0) {
@@ -226,3 +233,89 @@ void DavItemsListJob::davJobFinished(KJob *job)
     }
 }
 
+void DavItemsListJob::processResponse(DavJob *davJob, const DavMultistatusResponse &response)
+{
+    /*
+     * Extract data from a response like the following:
+     *
+     * <response xmlns="DAV:">
+     *   <href xmlns="DAV:">/caldav.php/test1.user/home/KOrganizer-166749289.780.ics</href>
+     *   <propstat xmlns="DAV:">
+     *     <prop xmlns="DAV:">
+     *       <getetag xmlns="DAV:">"b4bbea0278f4f63854c4167a7656024a"</getetag>
+     *     </prop>
+     *     <status xmlns="DAV:">HTTP/1.1 200 OK</status>
+     *   </propstat>
+     * </response>
+     */
+
+    // check for the valid propstat, without giving up on first error
+    const QDomElement propElement = response.successfulProp();
+    if (propElement.isNull()) {
+        return;
+    }
+
+    // check whether it is a dav collection ...
+    const QDomElement resourcetypeElement = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("resourcetype"));
+    const QDomElement collectionElement = Utils::firstChildElementNS(resourcetypeElement, QStringLiteral("DAV:"), QStringLiteral("collection"));
+    if (!collectionElement.isNull()) {
+        return;
+    }
+
+    // ... if not it is an item
+    DavItem item;
+    QString mimeType = davJob->property("itemsMimeType").toString();
+    if (davJob->property("combinedListing").toBool()) {
+        // The item is part of a combined listing, its data tells the type
+        const DavProtocolBase *protocol = DavManager::self()->davProtocol(d->mUrl.protocol());
+        mimeType = protocol->itemMimeType(propElement);
+        if (!d->mListedMimeTypes.contains(mimeType)) {
+            return;
+        }
+    }
+    item.setContentType(mimeType);
+
+    // extract path
+    const QString href = response.href();
+
+    QUrl url = davJob->url();
+    url.setUserInfo(QString());
+    if (href.startsWith(QLatin1Char('/'))) {
+        // href is only a path, use request url to complete
+        url.setPath(href, QUrl::TolerantMode);
+    } else {
+        // href is a complete url
+        url = QUrl::fromUserInput(href);
+    }
+
+    QString itemUrl = url.toDisplayString();
+    if (d->mSeenUrls.contains(itemUrl)) {
+        return;
+    }
+
+    d->mSeenUrls << itemUrl;
+    auto _url = url;
+    _url.setUserInfo(d->mUrl.url().userInfo());
+    item.setUrl(DavUrl(_url, d->mUrl.protocol()));
+
+    // extract etag
+    const QDomElement getetagElement = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("getetag"));
+
+    item.setEtag(getetagElement.text());
+
+    d->mDiscoveredItems << item;
+    if (d->mKeepItems) {
+        d->mItems << item;
+    }
+}
+
+void DavItemsListJob::flushDiscoveredItems()
+{
+    if (d->mDiscoveredItems.isEmpty()) {
+        return;
+    }
+
+    DavItem::List items;
+    items.swap(d->mDiscoveredItems);
+    Q_EMIT itemsDiscovered(items);
+}
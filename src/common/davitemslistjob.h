@@ -21,6 +21,7 @@
 
 #include "kpimkdav2_export.h"
 
+#include "davcollection.h"
 #include "davitem.h"
 #include "davjobbase.h"
 
@@ -29,11 +30,15 @@
 
 #include <QtCore/QStringList>
 
+class QDomDocument;
+
 class DavItemsListJobPrivate;
 
 namespace KDAV2
 {
 
+class DavJob;
+class DavMultistatusResponse;
 class DavUrl;
 
 /**
@@ -52,6 +57,18 @@ public:
      */
     DavItemsListJob(const DavUrl &url, QObject *parent = nullptr);
 
+    /**
+     * Creates a new dav items list job.
+     *
+     * Only the queries for the content types of the @p collection are sent,
+     * e.g. a task list is never asked for events. A collection that can't
+     * hold any listable content type is reported as empty.
+     *
+     * @param collection The DAV collection, with its content types.
+     * @param parent The parent object.
+     */
+    DavItemsListJob(const DavCollection &collection, QObject *parent = nullptr);
+
     ~DavItemsListJob();
 
     /**
@@ -71,6 +88,29 @@ public:
      */
     void setTimeRange(const QString &start, const QString &end);
 
+    /**
+     * Sets whether the discovered items are kept until the job has finished,
+     * to be returned by items().
+     *
+     * Callers that handle the items as they are announced by itemsDiscovered()
+     * can disable this to not hold the listing of the whole collection.
+     *
+     * Enabled by default.
+     */
+    void setKeepItems(bool keep);
+
+    /**
+     * Sets whether items of several mime types are listed with a single
+     * request, if the DAV dialect supports it.
+     *
+     * If the server rejects the combined request, the job falls back to a
+     * request per mime type. Disable this for servers that are known to
+     * need the separate requests.
+     *
+     * Enabled by default.
+     */
+    void setCombinedListing(bool combined);
+
     /**
      * Starts the job.
      */
@@ -78,13 +118,31 @@ public:
 
     /**
      * Returns the list of items seen including identifier url and etag information.
+     *
+     * This is empty if the items are not kept.
+     *
+     * @see setKeepItems()
      */
     DavItem::List items() const;
 
+Q_SIGNALS:
+    /**
+     * This signal is emitted every time items have been discovered while
+     * the listing is received.
+     *
+     * @param items The new items, with their url and etag
+     */
+    void itemsDiscovered(const KDAV2::DavItem::List &items);
+
 private Q_SLOTS:
     void davJobFinished(KJob *);
 
 private:
+    void startQuery(const QDomDocument &query, const QString &mimeType, bool combined);
+    void startPerTypeQueries();
+    void processResponse(DavJob *job, const DavMultistatusResponse &response);
+    void flushDiscoveredItems();
+
     std::unique_ptr<DavItemsListJobPrivate> d;
 };
 
@@ -18,10 +18,17 @@
 
 #include "davjob.h"
 
-#include "davmanager.h"
+#include "davrequestscheduler.h"
+#include "utils.h"
 #include "libkdav2_debug.h"
 
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QNetworkAccessManager>
+#include <QPointer>
 #include <QTextStream>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
 
 using namespace KDAV2;
 
@@ -31,6 +38,31 @@ public:
     QDomDocument doc;
     QUrl url;
 
+    DavJob::RequestSender sendRequest;
+    QPointer<QNetworkReply> reply;
+    QTimer timeoutTimer;
+    QTimer retryTimer;
+    Priority priority = NormalPriority;
+    QElapsedTimer queueTimer;
+    qint64 queueWaitTime = 0;
+
+    DavRetryPolicy retryPolicy = DavRetryPolicy::noRetries();
+    int retryCount = 0;
+
+    bool streaming = false;
+    DavMultistatusReader reader;
+    bool responsesDelivered = false;
+    // Set once the job has been killed, e.g. by a slot of responseParsed()
+    bool killed = false;
+
+    bool backgroundParsing = false;
+    // Received, but not handed to the thread pool yet
+    QByteArray pendingData;
+    bool replyFinished = false;
+    // Parsing in the thread pool, for the current attempt only
+    QPointer<QFutureWatcher<QVector<DavMultistatusResponse>>> responsesWatcher;
+    QPointer<QFutureWatcher<QDomDocument>> documentWatcher;
+
     QString location;
     QString etag;
     QString contentType;
@@ -43,17 +75,89 @@ DavJob::DavJob(QNetworkReply *reply, QUrl url, QObject *parent)
     d(new DavJobPrivate)
 {
     d->url = url;
+    init();
     connectToReply(reply);
 }
 
+DavJob::DavJob(const RequestSender &sendRequest, QUrl url, QObject *parent)
+    : KJob(parent),
+    d(new DavJobPrivate)
+{
+    d->url = url;
+    d->sendRequest = sendRequest;
+    d->queueTimer.start();
+    init();
+}
+
 DavJob::~DavJob()
 {
+    abortRequest();
+}
+
+void DavJob::init()
+{
+    d->timeoutTimer.setSingleShot(true);
+    QObject::connect(&d->timeoutTimer, &QTimer::timeout, this, [this] () {
+        qCWarning(KDAV2_LOG) << "Request timed out:" << d->url.toDisplayString(QUrl::RemoveUserInfo);
+        abortRequest();
+        d->responseCode = QNetworkReply::TimeoutError;
+        setError(KJob::UserDefinedError);
+        setErrorText(QStringLiteral("The request timed out"));
+        emitResult();
+    });
+
+    d->retryTimer.setSingleShot(true);
+    QObject::connect(&d->retryTimer, &QTimer::timeout, this, [this] () {
+        QNetworkReply *reply = d->reply;
+        connectToReply(resendRequest(reply, reply->request()));
+        reply->deleteLater();
+    });
+}
+
+void DavJob::abortRequest()
+{
+    d->sendRequest = nullptr;
+    d->timeoutTimer.stop();
+    d->retryTimer.stop();
+    stopParsing();
+    if (d->reply) {
+        d->reply->disconnect(this);
+        d->reply->abort();
+        d->reply->deleteLater();
+    }
+}
+
+bool DavJob::doKill()
+{
+    d->killed = true;
+    abortRequest();
+
+    // Nobody is going to look at what has been received so far
+    d->data.clear();
+    d->data.squeeze();
+    d->reader.clear();
+    d->doc.clear();
+    return true;
 }
 
 void DavJob::connectToReply(QNetworkReply *reply)
 {
+    d->reply = reply;
     QObject::connect(reply, &QNetworkReply::readyRead, this, [=] () {
-        d->data.append(reply->readAll());
+        const int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        // Bodies of redirects and errors are small, keep them around as they are
+        if (d->streaming && statusCode >= 200 && statusCode < 300) {
+            d->url = reply->url();
+            if (d->backgroundParsing) {
+                d->pendingData.append(reply->readAll());
+                parseInBackground();
+            } else {
+                d->reader.addData(reply->readAll());
+                readResponses();
+            }
+        } else {
+            d->data.append(reply->readAll());
+        }
     });
     QObject::connect(reply, static_cast<void(QNetworkReply::*)(QNetworkReply::NetworkError)>(&QNetworkReply::error), this, [=] (QNetworkReply::NetworkError error) {
         qCWarning(KDAV2_LOG) << "Network error:" << error << "Message:" << reply->errorString() << "HTTP Status code:" << reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() << "\nAvailable data:" << reply->readAll();
@@ -68,38 +172,52 @@ void DavJob::connectToReply(QNetworkReply *reply)
     QObject::connect(reply, &QNetworkReply::finished, this, [=] () {
         //This is a workaround for QNetworkAccessManager::setRedirectPolicy(QNetworkRequest::UserVerifiedRedirectPolicy),
         //which does not seem to work with multiple redirects.
-        const auto possibleRedirectUrl = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
-        if(!possibleRedirectUrl.isEmpty()) {
+        const auto redirectionTarget = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+        if(!redirectionTarget.isEmpty()) {
+            // The Location may be relative to the url of the request
+            const auto possibleRedirectUrl = reply->url().resolved(redirectionTarget);
             qCDebug(KDAV2_LOG) << "Redirecting to " << possibleRedirectUrl;
+            const int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            if (statusCode == 301 || statusCode == 308) {
+                Q_EMIT permanentlyRedirected(reply->url(), possibleRedirectUrl);
+            }
             auto request = reply->request();
             request.setUrl(possibleRedirectUrl);
+            if (DavRequestScheduler::origin(possibleRedirectUrl) != DavRequestScheduler::origin(reply->url())) {
+                // Don't hand the credentials of this server to another one
+                // unasked, they are still used to answer its challenge. The
+                // redirects remembered by DavSession behave the same.
+                request.setRawHeader("Authorization", QByteArray());
+            }
             reply->disconnect(this);
 
-            //Set in QWebdav
-            const auto requestData = reply->property("requestData").toByteArray();
+            stopParsing();
             d->data.clear();
+            d->reader.clear();
 
-            auto redirectReply = [&] {
-                if (reply->property("isPut").toBool()) {
-                    return DavManager::networkAccessManager()->put(request, requestData);
-                }
-                return DavManager::networkAccessManager()->sendCustomRequest(request, request.attribute(QNetworkRequest::CustomVerbAttribute).toByteArray(), requestData);
-            }();
-            redirectReply->setProperty("requestData", requestData);
-            connectToReply(redirectReply);
+            connectToReply(resendRequest(reply, request));
+            reply->deleteLater();
             return;
         }
 
-        //Could have changed due to redirects
-        d->url = reply->url();
+        const int retryDelay = this->retryDelay(reply);
+        if (retryDelay >= 0) {
+            ++d->retryCount;
+            qCDebug(KDAV2_LOG) << "Retrying" << reply->url() << "in" << retryDelay << "ms, attempt" << d->retryCount;
+            reply->disconnect(this);
 
-        d->doc.setContent(d->data, true);
+            stopParsing();
+            d->data.clear();
+            d->reader.clear();
 
-        if (KDAV2_LOG().isDebugEnabled()) {
-            QTextStream stream(stdout, QIODevice::WriteOnly);
-            d->doc.save(stream, 2);
+            d->retryTimer.start(retryDelay);
+            return;
         }
 
+        //Could have changed due to redirects
+        d->url = reply->url();
+
+        d->timeoutTimer.stop();
         d->responseCode = reply->error();
         d->httpStatusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
         if (d->responseCode) {
@@ -111,15 +229,331 @@ void DavJob::connectToReply(QNetworkReply *reply)
             setError(KJob::UserDefinedError);
             setErrorText(reply->errorString());
         }
+
+        if (d->streaming && d->data.isEmpty()) {
+            if (d->backgroundParsing) {
+                d->pendingData.append(reply->readAll());
+                d->replyFinished = true;
+                reply->deleteLater();
+                parseInBackground();
+                return;
+            }
+            d->reader.addData(reply->readAll());
+            QPointer<DavJob> guard(this);
+            readResponses();
+            // The slots may have killed or deleted the job meanwhile
+            if (!guard || d->killed) {
+                return;
+            }
+            reply->deleteLater();
+            finishStreaming();
+            return;
+        }
+
+        if (d->backgroundParsing && !d->data.isEmpty()) {
+            // The data stays available through data() meanwhile
+            const QByteArray data = d->data;
+            auto watcher = new QFutureWatcher<QDomDocument>(this);
+            d->documentWatcher = watcher;
+            QObject::connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher] () {
+                watcher->deleteLater();
+                if (watcher != d->documentWatcher) {
+                    return;
+                }
+                d->documentWatcher = nullptr;
+                d->doc = watcher->result();
+                if (KDAV2_LOG().isDebugEnabled()) {
+                    QTextStream stream(stdout, QIODevice::WriteOnly);
+                    d->doc.save(stream, 2);
+                }
+                emitResult();
+            });
+            watcher->setFuture(QtConcurrent::run([data] () {
+                QDomDocument document;
+                document.setContent(data, true);
+                return document;
+            }));
+            reply->deleteLater();
+            return;
+        }
+
+        d->doc.setContent(d->data, true);
+
+        if (KDAV2_LOG().isDebugEnabled()) {
+            QTextStream stream(stdout, QIODevice::WriteOnly);
+            d->doc.save(stream, 2);
+        }
+        reply->deleteLater();
         emitResult();
     });
 
 }
 
+bool DavJob::sendRequest()
+{
+    // Killed while waiting in the queue
+    if (!d->sendRequest) {
+        return false;
+    }
+    if (d->queueTimer.isValid()) {
+        d->queueWaitTime = d->queueTimer.elapsed();
+    }
+    connectToReply(d->sendRequest());
+    d->sendRequest = nullptr;
+    if (d->timeoutTimer.interval() > 0) {
+        d->timeoutTimer.start();
+    }
+    return true;
+}
+
+QNetworkReply *DavJob::resendRequest(QNetworkReply *reply, const QNetworkRequest &request)
+{
+    //Set in QWebdav
+    const auto requestData = reply->property("requestData").toByteArray();
+
+    // Stay in the session of the original request
+    auto manager = reply->manager();
+    auto newReply = [&] {
+        if (reply->property("isPut").toBool()) {
+            return manager->put(request, requestData);
+        }
+        if (reply->operation() == QNetworkAccessManager::GetOperation) {
+            return manager->get(request);
+        }
+        return manager->sendCustomRequest(request, requestVerb(reply), requestData);
+    }();
+    newReply->setProperty("requestData", requestData);
+    newReply->setProperty("isPut", reply->property("isPut"));
+    return newReply;
+}
+
+QByteArray DavJob::requestVerb(QNetworkReply *reply)
+{
+    switch (reply->operation()) {
+        case QNetworkAccessManager::HeadOperation:
+            return "HEAD";
+        case QNetworkAccessManager::GetOperation:
+            return "GET";
+        case QNetworkAccessManager::PutOperation:
+            return "PUT";
+        case QNetworkAccessManager::PostOperation:
+            return "POST";
+        case QNetworkAccessManager::DeleteOperation:
+            return "DELETE";
+        default:
+            return reply->request().attribute(QNetworkRequest::CustomVerbAttribute).toByteArray();
+    }
+}
+
+int DavJob::retryDelay(QNetworkReply *reply) const
+{
+    if (d->retryCount >= d->retryPolicy.maxRetries() || !DavRetryPolicy::isIdempotent(requestVerb(reply))) {
+        return -1;
+    }
+    // The responses passed on already can't be taken back
+    if (d->responsesDelivered) {
+        return -1;
+    }
+
+    const int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const bool connectionLost = reply->error() == QNetworkReply::RemoteHostClosedError
+                             || reply->error() == QNetworkReply::TemporaryNetworkFailureError;
+    if (!DavRetryPolicy::isTransientStatus(statusCode) && !connectionLost) {
+        return -1;
+    }
+
+    const qint64 retryAfter = DavRetryPolicy::parseRetryAfter(reply->rawHeader("Retry-After"));
+    if (retryAfter > d->retryPolicy.maxDelay()) {
+        qCDebug(KDAV2_LOG) << "Not retrying, the server asks to wait" << retryAfter << "ms";
+        return -1;
+    }
+    if (retryAfter >= 0) {
+        return retryAfter;
+    }
+    return d->retryPolicy.delay(d->retryCount + 1);
+}
+
+void DavJob::readResponses()
+{
+    QVector<DavMultistatusResponse> responses;
+    while (d->reader.readNextResponse()) {
+        responses << d->reader.response();
+    }
+    deliverResponses(responses);
+}
+
+void DavJob::deliverResponses(const QVector<DavMultistatusResponse> &responses)
+{
+    QPointer<DavJob> guard(this);
+    for (const DavMultistatusResponse &response : responses) {
+        if (KDAV2_LOG().isDebugEnabled()) {
+            QTextStream stream(stdout, QIODevice::WriteOnly);
+            response.element().save(stream, 2);
+        }
+
+        Q_EMIT responseParsed(response);
+        if (!guard || d->killed) {
+            return;
+        }
+    }
+
+    if (!responses.isEmpty()) {
+        d->responsesDelivered = true;
+        Q_EMIT responsesParsed();
+    }
+}
+
+void DavJob::parseInBackground()
+{
+    // The chunks are parsed one after the other, the next one is picked up
+    // once the running one is done
+    if (d->responsesWatcher) {
+        return;
+    }
+
+    if (d->pendingData.isEmpty()) {
+        if (d->replyFinished) {
+            finishStreaming();
+        }
+        return;
+    }
+
+    const QByteArray data = d->pendingData;
+    d->pendingData.clear();
+    DavMultistatusReader *reader = &d->reader;
+    auto watcher = new QFutureWatcher<QVector<DavMultistatusResponse>>(this);
+    d->responsesWatcher = watcher;
+    QObject::connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher] () {
+        watcher->deleteLater();
+        // Left over from an attempt that has been given up on
+        if (watcher != d->responsesWatcher) {
+            return;
+        }
+        d->responsesWatcher = nullptr;
+        QPointer<DavJob> guard(this);
+        deliverResponses(watcher->result());
+        if (!guard || d->killed) {
+            return;
+        }
+        parseInBackground();
+    });
+    watcher->setFuture(QtConcurrent::run([reader, data] () {
+        reader->addData(data);
+        QVector<DavMultistatusResponse> responses;
+        while (reader->readNextResponse()) {
+            responses << reader->response();
+        }
+        return responses;
+    }));
+}
+
+void DavJob::stopParsing()
+{
+    // The parser in the pool works on the reader, wait for it to let go.
+    // What it found belongs to an attempt that is given up on, the
+    // finished() signals still queued are ignored.
+    if (d->responsesWatcher) {
+        d->responsesWatcher->waitForFinished();
+        d->responsesWatcher->deleteLater();
+        d->responsesWatcher = nullptr;
+    }
+    if (d->documentWatcher) {
+        d->documentWatcher->waitForFinished();
+        d->documentWatcher->deleteLater();
+        d->documentWatcher = nullptr;
+    }
+    d->pendingData.clear();
+    d->replyFinished = false;
+}
+
+void DavJob::finishStreaming()
+{
+    if (d->reader.hasError() || (d->reader.isMultistatus() && !d->reader.atEnd())) {
+        qCWarning(KDAV2_LOG) << "Failed to parse the multistatus response:" << d->reader.errorString();
+    }
+    emitResult();
+}
+
 void DavJob::start()
 {
 }
 
+void DavJob::setStreaming(bool streaming)
+{
+    d->streaming = streaming;
+}
+
+void DavJob::setBackgroundParsing(bool background)
+{
+    d->backgroundParsing = background;
+}
+
+bool DavJob::backgroundParsing() const
+{
+    return d->backgroundParsing;
+}
+
+void DavJob::setRetryPolicy(const DavRetryPolicy &policy)
+{
+    d->retryPolicy = policy;
+}
+
+DavRetryPolicy DavJob::retryPolicy() const
+{
+    return d->retryPolicy;
+}
+
+int DavJob::retryCount() const
+{
+    return d->retryCount;
+}
+
+void DavJob::setTimeout(int msecs)
+{
+    d->timeoutTimer.setInterval(qMax(0, msecs));
+    if (msecs <= 0) {
+        d->timeoutTimer.stop();
+    } else if (d->reply) {
+        d->timeoutTimer.start();
+    }
+}
+
+int DavJob::timeout() const
+{
+    return d->timeoutTimer.interval();
+}
+
+void DavJob::setPriority(Priority priority)
+{
+    d->priority = priority;
+}
+
+Priority DavJob::priority() const
+{
+    return d->priority;
+}
+
+qint64 DavJob::queueWaitTime() const
+{
+    return d->queueWaitTime;
+}
+
+bool DavJob::isMultistatus() const
+{
+    if (d->streaming && d->data.isEmpty()) {
+        return d->reader.isMultistatus();
+    }
+    return d->doc.documentElement().localName().compare(QStringLiteral("multistatus"), Qt::CaseInsensitive) == 0;
+}
+
+QString DavJob::syncToken() const
+{
+    if (d->streaming && d->data.isEmpty()) {
+        return d->reader.syncToken();
+    }
+    return Utils::firstChildElementNS(d->doc.documentElement(), QStringLiteral("DAV:"), QStringLiteral("sync-token")).text().trimmed();
+}
+
 QDomDocument DavJob::response() const
 {
     return d->doc;
@@ -19,10 +19,15 @@
 #ifndef KDAV2_DAVJOB_H
 #define KDAV2_DAVJOB_H
 
+#include <functional>
 #include <memory>
 
 #include "kpimkdav2_export.h"
 
+#include "davmultistatusreader.h"
+#include "davretrypolicy.h"
+#include "enums.h"
+
 #include <KCoreAddons/KJob>
 #include <QDomDocument>
 #include <QUrl>
@@ -32,16 +37,123 @@ class DavJobPrivate;
 
 namespace KDAV2
 {
+class DavRequestScheduler;
+
 class KPIMKDAV2_EXPORT DavJob : public KJob
 {
     Q_OBJECT
 
 public:
+    /**
+     * Sends the request of a job and returns its reply.
+     */
+    typedef std::function<QNetworkReply *()> RequestSender;
+
     explicit DavJob(QNetworkReply *reply, QUrl url, QObject *parent = nullptr);
+
+    /**
+     * Creates a job whose request is sent later on by calling @p sendRequest,
+     * once the request scheduler of the session lets it through.
+     */
+    DavJob(const RequestSender &sendRequest, QUrl url, QObject *parent = nullptr);
     ~DavJob();
 
     virtual void start() Q_DECL_OVERRIDE;
 
+    /**
+     * Parse the response body incrementally as a multistatus document.
+     *
+     * Instead of collecting the whole body and building a DOM of it once the
+     * request has finished, every <response> element is passed to
+     * responseParsed() as soon as it has been received. response() and data()
+     * stay empty for successful requests in this mode.
+     *
+     * Must be called before control returns to the event loop.
+     */
+    void setStreaming(bool streaming);
+
+    /**
+     * Parse the response body in a thread of the global thread pool
+     * instead of the thread of the job.
+     *
+     * With streaming enabled, the chunks received are parsed one after the
+     * other in the pool, and responseParsed() is still emitted in the thread
+     * of the job. Otherwise the DOM of the body is built in the pool. In
+     * both cases result() is emitted only once everything has been parsed.
+     *
+     * Disabled by default, the jobs created by a session follow
+     * DavSession::backgroundParsing(). Must be called before control
+     * returns to the event loop.
+     */
+    void setBackgroundParsing(bool background);
+
+    /**
+     * Returns whether the response body is parsed in the thread pool.
+     */
+    bool backgroundParsing() const;
+
+    /**
+     * Sets the @p policy used to retry the request if it fails with a
+     * transient error.
+     *
+     * Streamed requests are not retried once responses have been passed
+     * to responseParsed(). Requests aren't retried by default.
+     */
+    void setRetryPolicy(const DavRetryPolicy &policy);
+
+    /**
+     * Returns the retry policy of the request.
+     */
+    DavRetryPolicy retryPolicy() const;
+
+    /**
+     * Returns how many times the request has been sent again after a
+     * transient error.
+     */
+    int retryCount() const;
+
+    /**
+     * Sets the time in milliseconds after which the request is aborted and
+     * the job fails, counted from when the request is sent. 0, the default,
+     * disables the timeout.
+     */
+    void setTimeout(int msecs);
+
+    /**
+     * Returns the timeout of the request in milliseconds.
+     */
+    int timeout() const;
+
+    /**
+     * Sets the @p priority of the request.
+     *
+     * Queued requests with a higher priority are sent first. Must be called
+     * before control returns to the event loop.
+     */
+    void setPriority(Priority priority);
+
+    /**
+     * Returns the priority of the request.
+     */
+    Priority priority() const;
+
+    /**
+     * Returns the time in milliseconds the request has been waiting in the
+     * queue of the request scheduler before being sent.
+     */
+    qint64 queueWaitTime() const;
+
+    /**
+     * Returns whether the response body is a DAV:multistatus document.
+     */
+    bool isMultistatus() const;
+
+    /**
+     * Returns the DAV:sync-token of a multistatus response to a
+     * sync-collection report, if any.
+     */
+    QString syncToken() const;
+
     QDomDocument response() const;
     QByteArray data() const;
     QUrl url() const;
@@ -51,7 +163,47 @@ public:
     QString getETagHeader() const;
     QString getContentTypeHeader() const;
 
+protected:
+    /**
+     * Aborts the request, whether it is still queued, in flight or waiting
+     * to be retried, and drops what has been received so far.
+     */
+    bool doKill() Q_DECL_OVERRIDE;
+
+Q_SIGNALS:
+    /**
+     * Emitted for every <response> element of the multistatus body, if
+     * streaming is enabled.
+     *
+     * @see setStreaming()
+     */
+    void responseParsed(const KDAV2::DavMultistatusResponse &response);
+
+    /**
+     * Emitted once all the complete responses of a chunk of received data
+     * have been passed to responseParsed(), if streaming is enabled.
+     */
+    void responsesParsed();
+
+    /**
+     * Emitted when the server answers the request to @p from with a
+     * permanent redirect (301 or 308) to @p to.
+     */
+    void permanentlyRedirected(const QUrl &from, const QUrl &to);
+
 private:
+    friend class DavRequestScheduler;
+    void init();
+    bool sendRequest();
+    void abortRequest();
+    QNetworkReply *resendRequest(QNetworkReply *reply, const QNetworkRequest &request);
+    static QByteArray requestVerb(QNetworkReply *reply);
+    int retryDelay(QNetworkReply *reply) const;
+    void readResponses();
+    void deliverResponses(const QVector<DavMultistatusResponse> &responses);
+    void parseInBackground();
+    void stopParsing();
+    void finishStreaming();
     void connectToReply(QNetworkReply *reply);
     std::unique_ptr<DavJobPrivate> d;
 };
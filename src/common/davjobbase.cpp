@@ -19,23 +19,77 @@
 #include "davjobbase.h"
 
 #include "davjob.h"
+#include "davmanager.h"
+
+#include <QtCore/QPointer>
+#include <QtCore/QTimer>
+#include <QtNetwork/QNetworkReply>
 
 using namespace KDAV2;
 
 struct DavJobBasePrivate {
     Error mError;
+    DavSession *mSession = nullptr;
+    Priority mPriority = NormalPriority;
+    QList<QPointer<KJob>> mSubjobs;
+    QTimer mTimeoutTimer;
 };
 
 DavJobBase::DavJobBase(QObject *parent)
     : KJob(parent)
     , d(std::unique_ptr<DavJobBasePrivate>(new DavJobBasePrivate()))
 {
+    d->mTimeoutTimer.setSingleShot(true);
+    connect(&d->mTimeoutTimer, &QTimer::timeout, this, [this] () {
+        killSubjobs();
+        setDavError(Error{ERR_TIMEOUT, 0, QNetworkReply::TimeoutError, QString(), 0});
+        emitResult();
+    });
+    connect(this, &KJob::finished, this, [this] () {
+        d->mTimeoutTimer.stop();
+    });
 }
 
 DavJobBase::~DavJobBase()
 {
 }
 
+void DavJobBase::setSession(DavSession *session)
+{
+    d->mSession = session;
+}
+
+DavSession *DavJobBase::session() const
+{
+    if (d->mSession) {
+        return d->mSession;
+    }
+    return DavManager::self()->defaultSession();
+}
+
+void DavJobBase::setPriority(Priority priority)
+{
+    d->mPriority = priority;
+}
+
+Priority DavJobBase::priority() const
+{
+    return d->mPriority;
+}
+
+void DavJobBase::setTimeout(int msecs)
+{
+    d->mTimeoutTimer.setInterval(qMax(0, msecs));
+    if (msecs <= 0) {
+        d->mTimeoutTimer.stop();
+    }
+}
+
+int DavJobBase::timeout() const
+{
+    return d->mTimeoutTimer.interval();
+}
+
 unsigned int DavJobBase::latestHttpStatusCode() const
 {
     return d->mError.httpStatusCode();
@@ -100,3 +154,45 @@ void DavJobBase::setErrorFromJob(DavJob *job, ErrorNumber errNo)
 {
     setDavError(Error{errNo, job->httpStatusCode(), job->responseCode(), job->errorText(), job->error()});
 }
+
+bool DavJobBase::doKill()
+{
+    d->mTimeoutTimer.stop();
+    killSubjobs();
+    return true;
+}
+
+void DavJobBase::killSubjobs()
+{
+    const auto subjobs = d->mSubjobs;
+    d->mSubjobs.clear();
+    for (const auto &job : subjobs) {
+        if (job) {
+            job->kill(KJob::Quietly);
+        }
+    }
+}
+
+void DavJobBase::addSubjob(KJob *job)
+{
+    d->mSubjobs.removeAll(QPointer<KJob>());
+    d->mSubjobs << job;
+
+    // The timeout runs from the first request on
+    if (d->mTimeoutTimer.interval() > 0 && !d->mTimeoutTimer.isActive()) {
+        d->mTimeoutTimer.start();
+    }
+}
+
+void DavJobBase::prepareJob(DavJob *job)
+{
+    job->setPriority(d->mPriority);
+    addSubjob(job);
+}
+
+void DavJobBase::prepareJob(DavJobBase *job)
+{
+    job->setSession(session());
+    job->setPriority(d->mPriority);
+    addSubjob(job);
+}
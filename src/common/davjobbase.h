@@ -23,6 +23,7 @@
 #include "kpimkdav2_export.h"
 #include <KJob>
 #include "daverror.h"
+#include "enums.h"
 
 struct DavJobBasePrivate;
 
@@ -30,6 +31,7 @@ namespace KDAV2
 {
 class Error;
 class DavJob;
+class DavSession;
 
 /**
  * @short base class for the jobs used by the resource.
@@ -42,6 +44,49 @@ public:
     explicit DavJobBase(QObject *parent = nullptr);
     ~DavJobBase();
 
+    /**
+     * Sets the @p session the job sends its requests with.
+     *
+     * Must be called before the job is started. The jobs started by this
+     * job use the same session. If no session is set, the default session
+     * of the DavManager is used.
+     */
+    void setSession(DavSession *session);
+
+    /**
+     * Returns the session the job sends its requests with.
+     */
+    DavSession *session() const;
+
+    /**
+     * Sets the @p priority of the requests of this job and of the jobs it
+     * starts.
+     *
+     * Must be called before the job is started. The default depends on the
+     * kind of job, e.g. fetching an item is interactive and listing the
+     * items of a collection happens in the background.
+     */
+    void setPriority(Priority priority);
+
+    /**
+     * Returns the priority of the requests of this job.
+     */
+    Priority priority() const;
+
+    /**
+     * Sets the time in milliseconds the job may take, counted from its
+     * first request. Once it has passed, the requests of the job are
+     * aborted and the job fails with ERR_TIMEOUT.
+     *
+     * 0, the default, disables the timeout.
+     */
+    void setTimeout(int msecs);
+
+    /**
+     * Returns the timeout of the job in milliseconds.
+     */
+    int timeout() const;
+
     /**
      * Get the latest http status code.
      *
@@ -94,6 +139,11 @@ public:
     Error davError() const;
 
 protected:
+    /**
+     * Aborts the requests of the job and kills the jobs it has started.
+     */
+    bool doKill() Q_DECL_OVERRIDE;
+
     void setErrorTextFromDavError();
     void setDavError(const Error &error);
 
@@ -101,7 +151,23 @@ protected:
      * Set the error of this job from a failed DavJob (executed by this job).
      */
     void setErrorFromJob(DavJob*, ErrorNumber jobErrorCode = ERR_PROBLEM_WITH_REQUEST);
+
+    /**
+     * Prepares the low-level @p job started by this job, e.g. sets its
+     * priority, and makes it part of this job, so that it is killed
+     * along with it.
+     */
+    void prepareJob(DavJob *job);
+
+    /**
+     * Prepares the @p job started by this job, so that it uses the session
+     * and the priority of this job and is killed along with it.
+     */
+    void prepareJob(DavJobBase *job);
 private:
+    void addSubjob(KJob *job);
+    void killSubjobs();
+
     std::unique_ptr<DavJobBasePrivate> d;
 };
 
@@ -22,7 +22,7 @@
 #include "protocols/carddavprotocol.h"
 #include "protocols/groupdavprotocol.h"
 #include "davjob.h"
-#include "qwebdavlib/qwebdav.h"
+#include "davsession.h"
 
 #include "libkdav2_debug.h"
 
@@ -34,8 +34,7 @@ using namespace KDAV2;
 DavManager *DavManager::mSelf = nullptr;
 
 DavManager::DavManager()
-    : mWebDav{new QWebdav},
-    mIgnoreSslErrors{true}
+    : mDefaultSession{new DavSession}
 {
 }
 
@@ -46,7 +45,7 @@ DavManager::~DavManager()
         it.next();
         delete it.value();
     }
-    delete mWebDav;
+    delete mDefaultSession;
 }
 
 DavManager *DavManager::self()
@@ -58,83 +57,59 @@ DavManager *DavManager::self()
     return mSelf;
 }
 
-void DavManager::setConnectionSettings(const QUrl &url)
+DavSession *DavManager::defaultSession() const
 {
-    mWebDav->setConnectionSettings(url.scheme() == "https" ? QWebdav::HTTPS : QWebdav::HTTP, url.host(), "/", url.userName(), url.password(), url.port(0), mIgnoreSslErrors);
+    return mDefaultSession;
 }
 
 DavJob *DavManager::createPropFindJob(const QUrl &url, const QDomDocument &document, const QString &depth)
 {
-    setConnectionSettings(url);
-    auto reply = mWebDav->propfind(url.path(), document.toByteArray(), depth.toInt());
-    return new DavJob{reply, url};
+    return mDefaultSession->createPropFindJob(url, document, depth);
 }
 
 DavJob *DavManager::createReportJob(const QUrl &url, const QDomDocument &document, const QString &depth)
 {
-    setConnectionSettings(url);
-    auto reply = mWebDav->report(url.path(), document.toByteArray(), depth.toInt());
-    return new DavJob{reply, url};
+    return mDefaultSession->createReportJob(url, document, depth);
 }
 
 DavJob *DavManager::createDeleteJob(const QUrl &url)
 {
-    setConnectionSettings(url);
-    auto reply = mWebDav->remove(url.path());
-    return new DavJob{reply, url};
+    return mDefaultSession->createDeleteJob(url);
 }
 
-
-DavJob *DavManager::createGetJob(const QUrl &url)
+DavJob *DavManager::createGetJob(const QUrl &url, const QByteArray &etag)
 {
-    setConnectionSettings(url);
-    // Work around a strange bug in Zimbra (seen at least on CE 5.0.18) : if the user-agent
-    // contains "Mozilla", some strange debug data is displayed in the shared calendars.
-    // This kinda mess up the events parsing...
-    auto reply = mWebDav->get(url.path(), {{"User-Agent", "KDAV2"}});
-    return new DavJob{reply, url};
+    return mDefaultSession->createGetJob(url, etag);
 }
 
 DavJob *DavManager::createPropPatchJob(const QUrl &url, const QDomDocument &document)
 {
-    setConnectionSettings(url);
-    auto reply = mWebDav->proppatch(url.path(), document.toByteArray());
-    return new DavJob{reply, url};
+    return mDefaultSession->createPropPatchJob(url, document);
 }
 
 DavJob *DavManager::createCreateJob(const QByteArray &data, const QUrl &url, const QByteArray &contentType)
 {
-    setConnectionSettings(url);
-    auto reply = mWebDav->put(url.path(), data, {{"Content-Type", contentType}, {"If-None-Match", "*"}});
-    return new DavJob{reply, url};
+    return mDefaultSession->createCreateJob(data, url, contentType);
 }
 
 DavJob *DavManager::createModifyJob(const QByteArray &data, const QUrl &url, const QByteArray &contentType, const QByteArray &etag)
 {
-    setConnectionSettings(url);
-    auto reply = mWebDav->put(url.path(), data, {{"Content-Type", contentType}, {"If-Match", etag}});
-    return new DavJob{reply, url};
+    return mDefaultSession->createModifyJob(data, url, contentType, etag);
 }
 
 DavJob *DavManager::createMkColJob(const QUrl &url)
 {
-    setConnectionSettings(url);
-    auto reply = mWebDav->mkdir(url.path());
-    return new DavJob{reply, url};
+    return mDefaultSession->createMkColJob(url);
 }
 
 DavJob *DavManager::createMkColJob(const QUrl &url, const QDomDocument &document)
 {
-    setConnectionSettings(url);
-    auto reply = mWebDav->mkdir(url.path(), document.toByteArray());
-    return new DavJob{reply, url};
+    return mDefaultSession->createMkColJob(url, document);
 }
 
 DavJob *DavManager::createMkCalendarJob(const QUrl &url, const QDomDocument &document)
 {
-    setConnectionSettings(url);
-    auto reply = mWebDav->mkcalendar(url.path(), document.toByteArray());
-    return new DavJob{reply, url};
+    return mDefaultSession->createMkCalendarJob(url, document);
 }
 
 const DavProtocolBase *DavManager::davProtocol(Protocol protocol)
@@ -172,11 +147,11 @@ bool DavManager::createProtocol(Protocol protocol)
 
 QNetworkAccessManager *DavManager::networkAccessManager()
 {
-    return DavManager::self()->mWebDav;
+    return DavManager::self()->mDefaultSession->networkAccessManager();
 }
 
 void DavManager::setIgnoreSslErrors(bool ignore)
 {
-    mIgnoreSslErrors = ignore;
+    mDefaultSession->setIgnoreSslErrors(ignore);
 }
 
@@ -30,7 +30,6 @@
 class QUrl;
 
 class QDomDocument;
-class QWebdav;
 class QNetworkAccessManager;
 
 namespace KDAV2
@@ -38,13 +37,18 @@ namespace KDAV2
 
 class DavJob;
 class DavProtocolBase;
+class DavSession;
 
 /**
  * @short A factory class for handling DAV jobs.
  *
- * This class provides factory methods to create preconfigured
- * low-level DAV jobs and has access to the global DAV protocol dialect
- * objects which abstract the access to the various DAV protocol dialects.
+ * This class has access to the global DAV protocol dialect objects which
+ * abstract the access to the various DAV protocol dialects and to the
+ * default session, that is used by the jobs that haven't been given
+ * a session of their own.
+ *
+ * The factory methods create preconfigured low-level DAV jobs in the
+ * default session.
  */
 class KPIMKDAV2_EXPORT DavManager
 {
@@ -59,6 +63,11 @@ public:
      */
     static DavManager *self();
 
+    /**
+     * Returns the session used by the jobs that don't have a session set.
+     */
+    DavSession *defaultSession() const;
+
     /**
      * Returns a preconfigured DAV PROPFIND job.
      *
@@ -72,8 +81,9 @@ public:
      * Returns a preconfigured DAV GET job.
      *
      * @param url The target url of the job.
+     * @param etag The etag to send in a If-None-Match header, if any.
      */
-    DavJob *createGetJob(const QUrl &url);
+    DavJob *createGetJob(const QUrl &url, const QByteArray &etag = QByteArray());
 
     /**
      * Returns a preconfigured DAV DELETE job.
@@ -147,12 +157,12 @@ public:
     const DavProtocolBase *davProtocol(Protocol protocol);
 
     /**
-     * Provides access to the internally used network access manager.
+     * Provides access to the network access manager of the default session.
      */
     static QNetworkAccessManager *networkAccessManager();
 
     /**
-     * Ignore all ssl errors.
+     * Ignore all ssl errors in the default session.
      *
      * If you want to handle ssl errors yourself via the networkAccessManager, then set to false.
      *
@@ -166,8 +176,6 @@ private:
      */
     DavManager();
 
-    void setConnectionSettings(const QUrl &url);
-
     /**
      * Creates a new protocol.
      */
@@ -176,8 +184,7 @@ private:
     typedef QMap<Protocol, DavProtocolBase *> protocolsMap;
     protocolsMap mProtocols;
     static DavManager *mSelf;
-    QWebdav *mWebDav;
-    bool mIgnoreSslErrors;
+    DavSession *mDefaultSession;
 };
 
 }
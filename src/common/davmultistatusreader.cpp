@@ -0,0 +1,248 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#include "davmultistatusreader.h"
+
+#include "utils.h"
+
+using namespace KDAV2;
+
+QDomElement DavMultistatusResponse::element() const
+{
+    return mDocument.documentElement();
+}
+
+QString DavMultistatusResponse::href() const
+{
+    return Utils::firstChildElementNS(element(), QStringLiteral("DAV:"), QStringLiteral("href")).text();
+}
+
+QString DavMultistatusResponse::status() const
+{
+    return Utils::firstChildElementNS(element(), QStringLiteral("DAV:"), QStringLiteral("status")).text();
+}
+
+QVector<QDomElement> DavMultistatusResponse::propstats() const
+{
+    QVector<QDomElement> result;
+
+    QDomElement propstatElement = Utils::firstChildElementNS(element(), QStringLiteral("DAV:"), QStringLiteral("propstat"));
+    while (!propstatElement.isNull()) {
+        result << propstatElement;
+        propstatElement = Utils::nextSiblingElementNS(propstatElement, QStringLiteral("DAV:"), QStringLiteral("propstat"));
+    }
+
+    return result;
+}
+
+QDomElement DavMultistatusResponse::successfulPropstat() const
+{
+    QDomElement result;
+
+    // check for the valid propstat, without giving up on first error
+    for (const QDomElement &propstatCandidate : propstats()) {
+        const QDomElement statusElement = Utils::firstChildElementNS(propstatCandidate, QStringLiteral("DAV:"), QStringLiteral("status"));
+        if (statusElement.text().contains(QLatin1String("200"))) {
+            result = propstatCandidate;
+        }
+    }
+
+    return result;
+}
+
+QDomElement DavMultistatusResponse::successfulProp() const
+{
+    return Utils::firstChildElementNS(successfulPropstat(), QStringLiteral("DAV:"), QStringLiteral("prop"));
+}
+
+
+DavMultistatusReader::DavMultistatusReader()
+    : mDepth(0), mIsMultistatus(false), mDocumentClosed(false), mInSyncToken(false)
+{
+}
+
+void DavMultistatusReader::addData(const QByteArray &data)
+{
+    mReader.addData(data);
+}
+
+bool DavMultistatusReader::readNextResponse()
+{
+    if (atEnd()) {
+        return false;
+    }
+
+    /*
+     * Only the <response> elements that are direct children of the
+     * <multistatus> document element are turned into DOM nodes, and only the
+     * text of the <sync-token> is kept from everything else:
+     *
+     * <multistatus xmlns="DAV:">      depth 1
+     *   <response>                    depth 2
+     *     <href>...</href>
+     *     <propstat>...</propstat>
+     *   </response>
+     *   <sync-token>...</sync-token>
+     * </multistatus>
+     */
+    while (true) {
+        // Invalid means either that we need more data or that the document
+        // is broken. In both cases there is nothing we can do for now.
+        switch (mReader.readNext()) {
+        case QXmlStreamReader::Invalid:
+        case QXmlStreamReader::EndDocument:
+            return false;
+
+        case QXmlStreamReader::StartElement: {
+            ++mDepth;
+
+            if (mDepth == 1) {
+                mIsMultistatus = mReader.namespaceUri() == QLatin1String("DAV:")
+                                 && mReader.name().compare(QLatin1String("multistatus"), Qt::CaseInsensitive) == 0;
+                break;
+            }
+
+            if (mDepth == 2 && mIsMultistatus
+                && mReader.namespaceUri() == QLatin1String("DAV:") && mReader.name() == QLatin1String("response")) {
+                mDocument = QDomDocument();
+                mCurrentNode = mDocument;
+            }
+
+            if (mDepth == 2 && mIsMultistatus
+                && mReader.namespaceUri() == QLatin1String("DAV:") && mReader.name() == QLatin1String("sync-token")) {
+                mInSyncToken = true;
+                mSyncToken.clear();
+            }
+
+            if (mCurrentNode.isNull()) {
+                break;
+            }
+
+            flushText();
+
+            QDomElement element = mDocument.createElementNS(mReader.namespaceUri().toString(), mReader.qualifiedName().toString());
+            const QXmlStreamAttributes attributes = mReader.attributes();
+            for (const QXmlStreamAttribute &attribute : attributes) {
+                if (attribute.namespaceUri().isEmpty()) {
+                    element.setAttribute(attribute.name().toString(), attribute.value().toString());
+                } else {
+                    element.setAttributeNS(attribute.namespaceUri().toString(), attribute.qualifiedName().toString(), attribute.value().toString());
+                }
+            }
+            mCurrentNode = mCurrentNode.appendChild(element);
+            break;
+        }
+
+        case QXmlStreamReader::EndElement:
+            --mDepth;
+
+            if (mInSyncToken && mDepth == 1) {
+                mInSyncToken = false;
+            }
+
+            if (mDepth == 0) {
+                // Don't wait for anything after the document element, in
+                // incremental mode the reader can't know that nothing follows.
+                mDocumentClosed = true;
+                return false;
+            }
+
+            if (mCurrentNode.isNull()) {
+                break;
+            }
+
+            flushText();
+            mCurrentNode = mCurrentNode.parentNode();
+
+            if (mDepth == 1) {
+                // The <response> element is complete
+                mResponse.mDocument = mDocument;
+                mDocument = QDomDocument();
+                mCurrentNode.clear();
+                return true;
+            }
+            break;
+
+        case QXmlStreamReader::Characters:
+            // Text can be delivered in several pieces when the data arrives
+            // in chunks, so collect it until the next element boundary.
+            if (!mCurrentNode.isNull()) {
+                mText += mReader.text();
+            } else if (mInSyncToken) {
+                mSyncToken += mReader.text();
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+void DavMultistatusReader::flushText()
+{
+    // Like QDomDocument::setContent(), drop text that only consists of whitespace
+    if (!mText.trimmed().isEmpty()) {
+        mCurrentNode.appendChild(mDocument.createTextNode(mText));
+    }
+    mText.clear();
+}
+
+DavMultistatusResponse DavMultistatusReader::response() const
+{
+    return mResponse;
+}
+
+bool DavMultistatusReader::isMultistatus() const
+{
+    return mIsMultistatus;
+}
+
+QString DavMultistatusReader::syncToken() const
+{
+    return mSyncToken.trimmed();
+}
+
+bool DavMultistatusReader::atEnd() const
+{
+    return mDocumentClosed || mReader.tokenType() == QXmlStreamReader::EndDocument;
+}
+
+bool DavMultistatusReader::hasError() const
+{
+    return mReader.hasError() && mReader.error() != QXmlStreamReader::PrematureEndOfDocumentError;
+}
+
+QString DavMultistatusReader::errorString() const
+{
+    return mReader.errorString();
+}
+
+void DavMultistatusReader::clear()
+{
+    mReader.clear();
+    mResponse = DavMultistatusResponse();
+    mDocument = QDomDocument();
+    mCurrentNode.clear();
+    mText.clear();
+    mSyncToken.clear();
+    mDepth = 0;
+    mIsMultistatus = false;
+    mDocumentClosed = false;
+    mInSyncToken = false;
+}
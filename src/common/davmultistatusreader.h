@@ -0,0 +1,175 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KDAV2_DAVMULTISTATUSREADER_H
+#define KDAV2_DAVMULTISTATUSREADER_H
+
+#include "kpimkdav2_export.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include <QtCore/QXmlStreamReader>
+#include <QtXml/QDomDocument>
+
+namespace KDAV2
+{
+
+/**
+ * @short A single <response> element of a multistatus document.
+ *
+ * Every response lives in its own small document, so it can be
+ * inspected with the DOM helpers from Utils without the rest of
+ * the multistatus being kept in memory.
+ */
+class KPIMKDAV2_EXPORT DavMultistatusResponse
+{
+public:
+    /**
+     * Returns the <response> element.
+     */
+    QDomElement element() const;
+
+    /**
+     * Returns the text of the <href> element of the response.
+     */
+    QString href() const;
+
+    /**
+     * Returns the response-level status line, e.g. "HTTP/1.1 404 Not Found"
+     * for an href of a multiget that does not exist.
+     *
+     * This is empty if the status is only given per propstat.
+     */
+    QString status() const;
+
+    /**
+     * Returns all <propstat> elements of the response.
+     */
+    QVector<QDomElement> propstats() const;
+
+    /**
+     * Returns the propstat element with a 200 status, or a null element.
+     *
+     * If several propstats have a 200 status the last one is returned.
+     */
+    QDomElement successfulPropstat() const;
+
+    /**
+     * Returns the <prop> element of successfulPropstat(), or a null element.
+     */
+    QDomElement successfulProp() const;
+
+private:
+    friend class DavMultistatusReader;
+
+    QDomDocument mDocument;
+};
+
+/**
+ * @short A pull parser for multistatus documents.
+ *
+ * The body of a multistatus response can be fed to the reader chunk by
+ * chunk with addData() as it arrives from the network. Every complete
+ * <response> element can then be pulled with readNextResponse(), so
+ * neither the raw body nor a DOM of the whole document has to be held
+ * in memory.
+ *
+ * @code
+ * reader.addData(reply->readAll());
+ * while (reader.readNextResponse()) {
+ *     handle(reader.response());
+ * }
+ * @endcode
+ */
+class KPIMKDAV2_EXPORT DavMultistatusReader
+{
+public:
+    DavMultistatusReader();
+
+    /**
+     * Appends a chunk of the document.
+     */
+    void addData(const QByteArray &data);
+
+    /**
+     * Parses the available data up to the end of the next <response> element.
+     *
+     * Returns true if a complete response has been read, it is then
+     * available from response(). Returns false if more data is needed,
+     * the document has been read completely or it is not well-formed.
+     */
+    bool readNextResponse();
+
+    /**
+     * Returns the response that has been read by the last successful
+     * call to readNextResponse().
+     */
+    DavMultistatusResponse response() const;
+
+    /**
+     * Returns true if the document element is a DAV:multistatus element.
+     */
+    bool isMultistatus() const;
+
+    /**
+     * Returns the DAV:sync-token of a sync-collection report (RFC 6578),
+     * once it has been read.
+     */
+    QString syncToken() const;
+
+    /**
+     * Returns true if the whole document has been read.
+     */
+    bool atEnd() const;
+
+    /**
+     * Returns true if the document is not well-formed.
+     *
+     * A document that is only incomplete so far is not an error.
+     */
+    bool hasError() const;
+
+    /**
+     * Returns a description of the parse error.
+     */
+    QString errorString() const;
+
+    /**
+     * Resets the reader so that a new document can be read.
+     */
+    void clear();
+
+private:
+    void flushText();
+
+    QXmlStreamReader mReader;
+    DavMultistatusResponse mResponse;
+    QDomDocument mDocument;
+    QDomNode mCurrentNode;
+    QString mText;
+    QString mSyncToken;
+    int mDepth;
+    bool mIsMultistatus;
+    bool mDocumentClosed;
+    bool mInSyncToken;
+};
+
+}
+
+#endif
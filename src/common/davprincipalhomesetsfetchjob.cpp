@@ -18,7 +18,9 @@
 
 #include "davprincipalhomesetsfetchjob.h"
 
+#include "davdiscoverycache.h"
 #include "davmanager.h"
+#include "davsession.h"
 #include "davprotocolbase.h"
 #include "daverror.h"
 #include "utils.h"
@@ -27,13 +29,56 @@
 using namespace KDAV2;
 
 DavPrincipalHomeSetsFetchJob::DavPrincipalHomeSetsFetchJob(const DavUrl &url, QObject *parent)
-    : DavJobBase(parent), mUrl(url)
+    : DavJobBase(parent), mRequestedUrl(url), mRevalidating(false), mUrl(url), mAtPrincipal(false)
 {
 }
 
+void DavPrincipalHomeSetsFetchJob::setAdditionalProtocols(const QList<Protocol> &protocols)
+{
+    mAdditionalProtocols = protocols;
+}
+
 void DavPrincipalHomeSetsFetchJob::start()
 {
-    fetchHomeSets(false);
+    DavDiscoveryCache *cache = session()->discoveryCache();
+    if (cache && !mRevalidating) {
+        QUrl principalUrl;
+        QStringList homeSets;
+        const auto result = cache->lookup(mRequestedUrl, principalUrl, homeSets, session());
+        if (result != DavDiscoveryCache::NotFound && !homeSets.isEmpty()) {
+            if (result == DavDiscoveryCache::Stale) {
+                revalidate();
+            }
+            mUrl.setUrl(principalUrl);
+            mHomeSets = homeSets;
+            emitResult();
+            return;
+        }
+    }
+
+    // Don't ask again for what an earlier job of the session already found
+    const QUrl principalUrl = mRevalidating ? QUrl() : session()->principalUrl(mUrl.url());
+    if (principalUrl.isValid()) {
+        mUrl.setUrl(principalUrl);
+    }
+    const QStringList homeSets = mRevalidating ? QStringList() : session()->homeSets(mUrl.url(), mUrl.protocol());
+    if (!homeSets.isEmpty()) {
+        mHomeSets = homeSets;
+        finishJob(principalUrl);
+        return;
+    }
+
+    fetchHomeSets(principalUrl.isValid());
+}
+
+void DavPrincipalHomeSetsFetchJob::revalidate()
+{
+    auto job = new DavPrincipalHomeSetsFetchJob(mRequestedUrl);
+    job->mRevalidating = true;
+    job->setAdditionalProtocols(mAdditionalProtocols);
+    job->setSession(session());
+    job->setPriority(BackgroundPriority);
+    job->start();
 }
 
 void DavPrincipalHomeSetsFetchJob::fetchHomeSets(bool homeSetsOnly)
@@ -46,16 +91,33 @@ void DavPrincipalHomeSetsFetchJob::fetchHomeSets(bool homeSetsOnly)
     QDomElement propElement = document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("prop"));
     propfindElement.appendChild(propElement);
 
-    const QString homeSet = DavManager::self()->davProtocol(mUrl.protocol())->principalHomeSet();
-    const QString homeSetNS = DavManager::self()->davProtocol(mUrl.protocol())->principalHomeSetNS();
-    propElement.appendChild(document.createElementNS(homeSetNS, homeSet));
+    // Ask for the home sets of all the protocols at once, but only for
+    // those that are still unknown
+    mRequestedProtocols.clear();
+    mRequestedProtocols << mUrl.protocol();
+    foreach (Protocol protocol, mAdditionalProtocols) {
+        if (!mRequestedProtocols.contains(protocol) && !mAdditionalHomeSets.contains(protocol)
+            && !DavManager::self()->davProtocol(protocol)->principalHomeSet().isEmpty()) {
+            mRequestedProtocols << protocol;
+        }
+    }
+
+    foreach (Protocol protocol, mRequestedProtocols) {
+        const QString homeSet = DavManager::self()->davProtocol(protocol)->principalHomeSet();
+        const QString homeSetNS = DavManager::self()->davProtocol(protocol)->principalHomeSetNS();
+        propElement.appendChild(document.createElementNS(homeSetNS, homeSet));
+    }
 
     if (!homeSetsOnly) {
         propElement.appendChild(document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("current-user-principal")));
         propElement.appendChild(document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("principal-URL")));
     }
+    mAtPrincipal = homeSetsOnly;
 
-    DavJob *job = DavManager::self()->createPropFindJob(mUrl.url(), document, QStringLiteral("0"));
+    DavJob *job = session()->createPropFindJob(mUrl.url(), document, QStringLiteral("0"));
+    prepareJob(job);
+    job->setStreaming(true);
+    connect(job, &DavJob::responseParsed, this, &DavPrincipalHomeSetsFetchJob::processResponse);
     connect(job, &DavJob::result, this, &DavPrincipalHomeSetsFetchJob::davJobFinished);
 }
 
@@ -72,15 +134,86 @@ void DavPrincipalHomeSetsFetchJob::davJobFinished(KJob *job)
 {
     auto davJob = static_cast<DavJob*>(job);
     if (davJob->error()) {
+        if (davJob->httpStatusCode() == 403 || davJob->httpStatusCode() == 404) {
+            if (DavDiscoveryCache *cache = session()->discoveryCache()) {
+                cache->remove(mRequestedUrl, session());
+            }
+            session()->setPrincipalUrl(mRequestedUrl.url(), QUrl());
+        }
         setErrorFromJob(davJob);
         emitResult();
         return;
     }
 
+    mUrl.setUrl(davJob->url());
+
+    QUrl principalUrl;
+    if (mAtPrincipal) {
+        principalUrl = mUrl.url();
+    } else if (!mNextRoundHref.isEmpty()) {
+        principalUrl = mUrl.url();
+
+        if (mNextRoundHref.startsWith(QLatin1Char('/'))) {
+            // nextRoundHref is only a path, use request url to complete
+            principalUrl.setPath(mNextRoundHref, QUrl::TolerantMode);
+        } else {
+            // href is a complete url
+            principalUrl = QUrl::fromUserInput(mNextRoundHref);
+            principalUrl.setUserName(mUrl.url().userName());
+            principalUrl.setPassword(mUrl.url().password());
+        }
+        mNextRoundHref.clear();
+    }
+
     /*
-     * Extract information from a document like the following (if no homeset is defined) :
+     * Now either we got one or more homesets, or we got an href for the next round
+     * or nothing can be found by this job.
+     * If we have homesets, we're done here and can notify the caller.
+     * Else we must ensure that we have an href for the next round.
+     */
+    if (!mHomeSets.isEmpty() || !principalUrl.isValid() || mAtPrincipal) {
+        finishJob(principalUrl);
+    } else {
+        mUrl.setUrl(principalUrl);
+        // And one more round, fetching only homesets
+        fetchHomeSets(true);
+    }
+}
+
+void DavPrincipalHomeSetsFetchJob::finishJob(const QUrl &principalUrl)
+{
+    // The home sets belong to the principal if it is known, else to the
+    // url that answered
+    const QUrl homeSetsUrl = principalUrl.isValid() ? principalUrl : mUrl.url();
+    if (principalUrl.isValid()) {
+        session()->setPrincipalUrl(mRequestedUrl.url(), principalUrl);
+        session()->setPrincipalUrl(principalUrl, principalUrl);
+    }
+    session()->setHomeSets(homeSetsUrl, mUrl.protocol(), mHomeSets);
+    for (auto it = mAdditionalHomeSets.constBegin(); it != mAdditionalHomeSets.constEnd(); ++it) {
+        session()->setHomeSets(homeSetsUrl, static_cast<Protocol>(it.key()), it.value());
+    }
+
+    DavDiscoveryCache *cache = session()->discoveryCache();
+    if (cache && !mHomeSets.isEmpty()) {
+        cache->insert(mRequestedUrl, homeSetsUrl, mHomeSets, session());
+    }
+    if (cache) {
+        // The same url with the other protocols finds them after a restart
+        for (auto it = mAdditionalHomeSets.constBegin(); it != mAdditionalHomeSets.constEnd(); ++it) {
+            if (!it.value().isEmpty()) {
+                cache->insert(DavUrl(mRequestedUrl.url(), static_cast<Protocol>(it.key())), homeSetsUrl, it.value(), session());
+            }
+        }
+    }
+    emitResult();
+}
+
+void DavPrincipalHomeSetsFetchJob::processResponse(const DavMultistatusResponse &response)
+{
+    /*
+     * Extract information from a response like the following (if no homeset is defined) :
      *
-     * <D:multistatus xmlns:D="DAV:">
      *  <D:response xmlns:D="DAV:">
      *   <D:href xmlns:D="DAV:">/dav/</D:href>
      *   <D:propstat xmlns:D="DAV:">
@@ -99,12 +232,9 @@ void DavPrincipalHomeSetsFetchJob::davJobFinished(KJob *job)
      *    </D:prop>
      *   </D:propstat>
      *  </D:response>
-     * </D:multistatus>
      *
      * Or like this (if the homeset is defined):
      *
-     *  <?xml version="1.0" encoding="utf-8" ?>
-     *  <multistatus xmlns="DAV:" xmlns:C="urn:ietf:params:xml:ns:caldav">
      *    <response>
      *      <href>/principals/users/greg%40kamago.net/</href>
      *      <propstat>
@@ -116,96 +246,47 @@ void DavPrincipalHomeSetsFetchJob::davJobFinished(KJob *job)
      *        <status>HTTP/1.1 200 OK</status>
      *      </propstat>
      *    </response>
-     *  </multistatus>
      */
 
-    mUrl.setUrl(davJob->url());
-    const QString homeSet = DavManager::self()->davProtocol(mUrl.protocol())->principalHomeSet();
-    const QString homeSetNS = DavManager::self()->davProtocol(mUrl.protocol())->principalHomeSetNS();
-    QString nextRoundHref; // The content of the href element that will be used if no homeset was found.
-    // This is either given by current-user-principal or by principal-URL.
-
-    const QDomDocument document = davJob->response();
-    const QDomElement multistatusElement = document.documentElement();
-
-    QDomElement responseElement = Utils::firstChildElementNS(multistatusElement, QStringLiteral("DAV:"), QStringLiteral("response"));
-    while (!responseElement.isNull()) {
-
-        const QDomElement propstatElement = [&] {
-            // check for the valid propstat, without giving up on first error
-            const QDomNodeList propstats = responseElement.elementsByTagNameNS(QStringLiteral("DAV:"), QStringLiteral("propstat"));
-            for (int i = 0; i < propstats.length(); ++i) {
-                const QDomElement propstatCandidate = propstats.item(i).toElement();
-                const QDomElement statusElement = Utils::firstChildElementNS(propstatCandidate, QStringLiteral("DAV:"), QStringLiteral("status"));
-                if (statusElement.text().contains(QLatin1String("200"))) {
-                    return propstatCandidate;
-                }
-            }
-            return QDomElement{};
-        }();
+    // check for the valid propstat, without giving up on first error
+    const QDomElement propElement = response.successfulProp();
+    if (propElement.isNull()) {
+        return;
+    }
 
-        if (propstatElement.isNull()) {
-            responseElement = Utils::nextSiblingElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
+    // extract home sets
+    foreach (Protocol protocol, mRequestedProtocols) {
+        const QString homeSet = DavManager::self()->davProtocol(protocol)->principalHomeSet();
+        const QString homeSetNS = DavManager::self()->davProtocol(protocol)->principalHomeSetNS();
+        const QDomElement homeSetElement = Utils::firstChildElementNS(propElement, homeSetNS, homeSet);
+        if (homeSetElement.isNull()) {
             continue;
         }
 
-        // extract home sets
-        const QDomElement propElement = Utils::firstChildElementNS(propstatElement, QStringLiteral("DAV:"), QStringLiteral("prop"));
-        const QDomElement homeSetElement = Utils::firstChildElementNS(propElement, homeSetNS, homeSet);
-
-        if (!homeSetElement.isNull()) {
-            QDomElement hrefElement = Utils::firstChildElementNS(homeSetElement, QStringLiteral("DAV:"), QStringLiteral("href"));
-
-            while (!hrefElement.isNull()) {
-                const QString href = hrefElement.text();
-                if (!mHomeSets.contains(href)) {
-                    mHomeSets << href;
-                }
+        QStringList &homeSets = protocol == mUrl.protocol() ? mHomeSets : mAdditionalHomeSets[protocol];
+        QDomElement hrefElement = Utils::firstChildElementNS(homeSetElement, QStringLiteral("DAV:"), QStringLiteral("href"));
 
-                hrefElement = Utils::nextSiblingElementNS(hrefElement, QStringLiteral("DAV:"), QStringLiteral("href"));
-            }
-        } else {
-            // Trying to get the principal url, given either by current-user-principal or principal-URL
-            QDomElement urlHolder = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("current-user-principal"));
-            if (urlHolder.isNull()) {
-                urlHolder = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("principal-URL"));
+        while (!hrefElement.isNull()) {
+            const QString href = hrefElement.text();
+            if (!homeSets.contains(href)) {
+                homeSets << href;
             }
 
-            if (!urlHolder.isNull()) {
-                // Getting the href that will be used for the next round
-                QDomElement hrefElement = Utils::firstChildElementNS(urlHolder, QStringLiteral("DAV:"), QStringLiteral("href"));
-                if (!hrefElement.isNull()) {
-                    nextRoundHref = hrefElement.text();
-                }
-            }
+            hrefElement = Utils::nextSiblingElementNS(hrefElement, QStringLiteral("DAV:"), QStringLiteral("href"));
         }
-
-        responseElement = Utils::nextSiblingElementNS(responseElement, QStringLiteral("DAV:"), QStringLiteral("response"));
     }
 
-    /*
-     * Now either we got one or more homesets, or we got an href for the next round
-     * or nothing can be found by this job.
-     * If we have homesets, we're done here and can notify the caller.
-     * Else we must ensure that we have an href for the next round.
-     */
-    if (!mHomeSets.isEmpty() || nextRoundHref.isEmpty()) {
-        emitResult();
-    } else {
-        QUrl nextRoundUrl(mUrl.url());
+    // Trying to get the principal url, given either by current-user-principal or principal-URL
+    QDomElement urlHolder = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("current-user-principal"));
+    if (urlHolder.isNull()) {
+        urlHolder = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("principal-URL"));
+    }
 
-        if (nextRoundHref.startsWith(QLatin1Char('/'))) {
-            // nextRoundHref is only a path, use request url to complete
-            nextRoundUrl.setPath(nextRoundHref, QUrl::TolerantMode);
-        } else {
-            // href is a complete url
-            nextRoundUrl = QUrl::fromUserInput(nextRoundHref);
-            nextRoundUrl.setUserName(mUrl.url().userName());
-            nextRoundUrl.setPassword(mUrl.url().password());
+    if (!urlHolder.isNull()) {
+        // Getting the href that will be used for the next round
+        QDomElement hrefElement = Utils::firstChildElementNS(urlHolder, QStringLiteral("DAV:"), QStringLiteral("href"));
+        if (!hrefElement.isNull()) {
+            mNextRoundHref = hrefElement.text();
         }
-
-        mUrl.setUrl(nextRoundUrl);
-        // And one more round, fetching only homesets
-        fetchHomeSets(true);
     }
 }
@@ -26,13 +26,20 @@
 
 #include <KCoreAddons/KJob>
 
+#include <QtCore/QHash>
+#include <QtCore/QList>
 #include <QtCore/QStringList>
 
 namespace KDAV2
 {
 
+class DavMultistatusResponse;
+
 /**
  * @short A job that fetches home sets for a principal.
+ *
+ * The principal url and the home sets found are remembered in the session,
+ * so that later jobs for the same url don't ask the server again.
  */
 class KPIMKDAV2_EXPORT DavPrincipalHomeSetsFetchJob : public DavJobBase
 {
@@ -47,6 +54,18 @@ public:
      */
     explicit DavPrincipalHomeSetsFetchJob(const DavUrl &url, QObject *parent = nullptr);
 
+    /**
+     * Sets further @p protocols whose home sets are asked for in the same
+     * requests, e.g. CardDav when fetching the CalDav home sets of an
+     * account that has both.
+     *
+     * Their home sets are only remembered in the session, where later jobs
+     * for the same url find them.
+     *
+     * @see DavSession::homeSets()
+     */
+    void setAdditionalProtocols(const QList<Protocol> &protocols);
+
     /**
      * Starts the job.
      */
@@ -76,8 +95,35 @@ private:
      */
     void fetchHomeSets(bool fetchHomeSetsOnly);
 
+    void processResponse(const DavMultistatusResponse &response);
+
+    /**
+     * Remembers the principal url and the home sets found and emits the
+     * result.
+     */
+    void finishJob(const QUrl &principalUrl);
+
+    /**
+     * Fetches the home sets of the requested url again in the background,
+     * to update the discovery cache.
+     */
+    void revalidate();
+
+    // The url given to the job, the key in the discovery cache
+    DavUrl mRequestedUrl;
+    bool mRevalidating;
     DavUrl mUrl;
+    QList<Protocol> mAdditionalProtocols;
+    // The protocols asked for in the current request
+    QList<Protocol> mRequestedProtocols;
+    // Whether the current request goes to the principal
+    bool mAtPrincipal;
     QStringList mHomeSets;
+    // The home sets of the additional protocols
+    QHash<int, QStringList> mAdditionalHomeSets;
+    // The content of the href element that will be used if no homeset was found.
+    // This is either given by current-user-principal or by principal-URL.
+    QString mNextRoundHref;
 };
 
 }
@@ -18,7 +18,7 @@
 
 #include "davprincipalsearchjob.h"
 
-#include "davmanager.h"
+#include "davsession.h"
 #include "utils.h"
 #include "daverror.h"
 #include "davjob.h"
@@ -72,7 +72,8 @@ void DavPrincipalSearchJob::start()
     QDomElement principalCollectionSet = query.createElementNS(QStringLiteral("DAV:"), QStringLiteral("principal-collection-set"));
     prop.appendChild(principalCollectionSet);
 
-    DavJob *job = DavManager::self()->createPropFindJob(mUrl.url(), query);
+    DavJob *job = session()->createPropFindJob(mUrl.url(), query);
+    prepareJob(job);
     connect(job, &DavJob::result, this, &DavPrincipalSearchJob::principalCollectionSetSearchFinished);
     job->start();
 }
@@ -172,7 +173,8 @@ void DavPrincipalSearchJob::principalCollectionSetSearchFinished(KJob *job)
 
         QDomDocument principalPropertySearchQuery;
         buildReportQuery(principalPropertySearchQuery);
-        DavJob *reportJob = DavManager::self()->createReportJob(url, principalPropertySearchQuery);
+        DavJob *reportJob = session()->createReportJob(url, principalPropertySearchQuery);
+        prepareJob(reportJob);
         connect(reportJob, &DavJob::result, this, &DavPrincipalSearchJob::principalPropertySearchFinished);
         ++mPrincipalPropertySearchSubJobCount;
         reportJob->start();
@@ -17,6 +17,7 @@
 */
 
 #include "davprotocolbase.h"
+#include "utils.h"
 
 #include <QVariant>
 
@@ -44,6 +45,33 @@ DavProtocolBase::~DavProtocolBase()
 {
 }
 
+bool DavProtocolBase::supportsSyncCollection() const
+{
+    return false;
+}
+
+XMLQueryBuilder::Ptr DavProtocolBase::combinedItemsQuery() const
+{
+    return XMLQueryBuilder::Ptr();
+}
+
+QStringList DavProtocolBase::itemsMimeTypes(DavCollection::ContentTypes contentTypes) const
+{
+    Q_UNUSED(contentTypes);
+
+    QStringList mimeTypes;
+    for (const XMLQueryBuilder::Ptr &builder : itemsQueries()) {
+        mimeTypes << builder->mimeType();
+    }
+    return mimeTypes;
+}
+
+QString DavProtocolBase::itemMimeType(const QDomElement &prop) const
+{
+    Q_UNUSED(prop);
+    return QString();
+}
+
 QString DavProtocolBase::principalHomeSet() const
 {
     return QString();
@@ -53,3 +81,43 @@ QString DavProtocolBase::principalHomeSetNS() const
 {
     return QString();
 }
+
+bool DavProtocolBase::isCollectionResponse(const QDomElement &response) const
+{
+    /*
+     * Look for the resource types in a response like the following, checking
+     * every propstat as the status doesn't matter here:
+     *
+     * <response xmlns="DAV:">
+     *   <href xmlns="DAV:">/caldav.php/test1.user/home/</href>
+     *   <propstat xmlns="DAV:">
+     *     <prop xmlns="DAV:">
+     *       <resourcetype xmlns="DAV:">
+     *         <collection xmlns="DAV:"/>
+     *         <C:calendar xmlns:C="urn:ietf:params:xml:ns:caldav"/>
+     *       </resourcetype>
+     *     </prop>
+     *   </propstat>
+     * </response>
+     */
+    const QVector<QPair<QString, QString>> resourceTypes = collectionResourceTypes();
+
+    QDomElement propstatElement = Utils::firstChildElementNS(response, QStringLiteral("DAV:"), QStringLiteral("propstat"));
+    while (!propstatElement.isNull()) {
+        const QDomElement propElement = Utils::firstChildElementNS(propstatElement, QStringLiteral("DAV:"), QStringLiteral("prop"));
+        const QDomElement resourcetypeElement = Utils::firstChildElementNS(propElement, QStringLiteral("DAV:"), QStringLiteral("resourcetype"));
+
+        QDomElement typeElement = resourcetypeElement.firstChildElement();
+        while (!typeElement.isNull()) {
+            const QPair<QString, QString> type(typeElement.namespaceURI(), typeElement.localName());
+            if (resourceTypes.contains(type)) {
+                return true;
+            }
+            typeElement = typeElement.nextSiblingElement();
+        }
+
+        propstatElement = Utils::nextSiblingElementNS(propstatElement, QStringLiteral("DAV:"), QStringLiteral("propstat"));
+    }
+
+    return false;
+}
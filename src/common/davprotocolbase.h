@@ -25,6 +25,9 @@
 
 #include <QtCore/QList>
 #include <QtCore/QMap>
+#include <QtCore/QPair>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
 #include <QtXml/QDomDocument>
 #include <QSharedPointer>
 #include <QVariant>
@@ -106,6 +109,14 @@ public:
      */
     virtual bool useMultiget() const = 0;
 
+    /**
+     * Returns whether the dav protocol dialect supports the sync-collection
+     * REPORT defined in RFC 6578 to query the changes of a collection.
+     *
+     * Returns false by default.
+     */
+    virtual bool supportsSyncCollection() const;
+
     /**
      * Returns the home set that this protocol supports.
      */
@@ -123,10 +134,19 @@ public:
     virtual XMLQueryBuilder::Ptr collectionsQuery() const = 0;
 
     /**
-     * Returns the XQuery string that filters out the relevant XML elements
-     * from the result returned by the query that is provided by collectionQuery().
+     * Returns the resource types that mark the relevant collections in the
+     * result returned by the query that is provided by collectionsQuery(),
+     * as pairs of namespace and element name.
      */
-    virtual QString collectionsXQuery() const = 0;
+    virtual QVector<QPair<QString, QString>> collectionResourceTypes() const = 0;
+
+    /**
+     * Returns whether the @p response element of the result returned by the
+     * query that is provided by collectionsQuery() describes a relevant
+     * collection, that is whether one of its resource types is listed in
+     * collectionResourceTypes().
+     */
+    bool isCollectionResponse(const QDomElement &response) const;
 
     /**
      * Returns a list of XML documents that represent DAV queries to
@@ -134,6 +154,30 @@ public:
      */
     virtual QVector<XMLQueryBuilder::Ptr> itemsQueries() const = 0;
 
+    /**
+     * Returns a XML document that represents a DAV query to list the DAV
+     * resources of several of the mime types of itemsQueries() at once, or
+     * a null pointer if the dialect doesn't support this.
+     *
+     * The mime types to list are passed in the "mimeTypes" parameter, the
+     * mime type of each resource is determined with itemMimeType().
+     */
+    virtual XMLQueryBuilder::Ptr combinedItemsQuery() const;
+
+    /**
+     * Returns the mime types of the queries provided by itemsQueries() that
+     * can find resources in a collection with the given @p contentTypes.
+     *
+     * The default implementation returns the mime types of all the queries.
+     */
+    virtual QStringList itemsMimeTypes(DavCollection::ContentTypes contentTypes) const;
+
+    /**
+     * Returns the mime type of the resource described by the @p prop element
+     * of a result returned by the query provided by combinedItemsQuery().
+     */
+    virtual QString itemMimeType(const QDomElement &prop) const;
+
     /**
      * Returns the possible content types for the collection that
      * is described by the passed @p propstat element of a PROPFIND result.
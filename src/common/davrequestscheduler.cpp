@@ -0,0 +1,166 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#include "davrequestscheduler.h"
+
+#include "davjob.h"
+
+#include <QtCore/QMetaObject>
+#include <QtCore/QUrl>
+
+using namespace KDAV2;
+
+// The number of connections QNetworkAccessManager opens per host
+static const int DefaultMaxRequestsPerOrigin = 6;
+
+DavRequestScheduler::DavRequestScheduler(QObject *parent)
+    : QObject(parent)
+    , mMaxRequestsPerOrigin(DefaultMaxRequestsPerOrigin)
+{
+}
+
+DavRequestScheduler::~DavRequestScheduler()
+{
+}
+
+QString DavRequestScheduler::origin(const QUrl &url)
+{
+    return url.adjusted(QUrl::RemoveUserInfo | QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment).toString();
+}
+
+void DavRequestScheduler::setMaxRequestsPerOrigin(int max)
+{
+    mMaxRequestsPerOrigin = qMax(1, max);
+    scheduleDispatch();
+}
+
+int DavRequestScheduler::maxRequestsPerOrigin() const
+{
+    return mMaxRequestsPerOrigin;
+}
+
+void DavRequestScheduler::enqueue(DavJob *job)
+{
+    mOrigins[origin(job->url())].queue << job;
+    scheduleDispatch();
+}
+
+void DavRequestScheduler::scheduleDispatch()
+{
+    // Dispatch from the event loop, so that the creator of a job can still
+    // configure it, e.g. set its priority.
+    if (!mDispatchScheduled) {
+        mDispatchScheduled = true;
+        QMetaObject::invokeMethod(this, "dispatch", Qt::QueuedConnection);
+    }
+}
+
+void DavRequestScheduler::dispatch()
+{
+    mDispatchScheduled = false;
+
+    for (auto it = mOrigins.begin(); it != mOrigins.end(); ++it) {
+        const QString key = it.key();
+        Origin &origin = it.value();
+
+        while (origin.running.size() < mMaxRequestsPerOrigin && !origin.queue.isEmpty()) {
+            // The first job of the highest priority, skipping the deleted ones
+            int next = -1;
+            for (int i = 0; i < origin.queue.size(); ++i) {
+                const auto job = origin.queue.at(i);
+                if (!job) {
+                    origin.queue.removeAt(i--);
+                    continue;
+                }
+                if (next < 0 || job->priority() < origin.queue.at(next)->priority()) {
+                    next = i;
+                }
+            }
+            if (next < 0) {
+                break;
+            }
+
+            DavJob *job = origin.queue.takeAt(next);
+            if (!job->sendRequest()) {
+                continue;
+            }
+            origin.running << job;
+            connect(job, &KJob::finished, this, [this, key, job] {
+                requestDone(key, job);
+            });
+            connect(job, &QObject::destroyed, this, [this, key](QObject *job) {
+                requestDone(key, job);
+            });
+
+            const qint64 waitTime = job->queueWaitTime();
+            mTotalWaitTime += waitTime;
+            mMaxWaitTime = qMax(mMaxWaitTime, waitTime);
+            ++mSentCount;
+        }
+    }
+}
+
+void DavRequestScheduler::requestDone(const QString &origin, QObject *job)
+{
+    auto it = mOrigins.find(origin);
+    if (it == mOrigins.end() || !it->running.remove(job)) {
+        return;
+    }
+    if (it->running.isEmpty() && it->queue.isEmpty()) {
+        mOrigins.erase(it);
+    } else {
+        scheduleDispatch();
+    }
+}
+
+int DavRequestScheduler::queuedRequestCount(const QUrl &url) const
+{
+    int count = 0;
+    for (auto it = mOrigins.constBegin(); it != mOrigins.constEnd(); ++it) {
+        if (url.isEmpty() || it.key() == origin(url)) {
+            for (const auto &job : it->queue) {
+                if (job) {
+                    ++count;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+int DavRequestScheduler::runningRequestCount(const QUrl &url) const
+{
+    int count = 0;
+    for (auto it = mOrigins.constBegin(); it != mOrigins.constEnd(); ++it) {
+        if (url.isEmpty() || it.key() == origin(url)) {
+            count += it->running.size();
+        }
+    }
+    return count;
+}
+
+qint64 DavRequestScheduler::averageWaitTime() const
+{
+    return mSentCount ? mTotalWaitTime / mSentCount : 0;
+}
+
+qint64 DavRequestScheduler::maxWaitTime() const
+{
+    return mMaxWaitTime;
+}
@@ -0,0 +1,115 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef KDAV2_DAVREQUESTSCHEDULER_H
+#define KDAV2_DAVREQUESTSCHEDULER_H
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QSet>
+
+class QUrl;
+
+namespace KDAV2
+{
+
+class DavJob;
+
+/**
+ * @short Queues the requests of a session per origin.
+ *
+ * At most maxRequestsPerOrigin() requests are sent at the same time to
+ * the same scheme, host and port. The others wait in a queue, from which
+ * the request with the highest priority is sent first whenever a request
+ * to the same origin finishes.
+ *
+ * The priority of a job is read when its request is sent, so it can be
+ * changed until control returns to the event loop.
+ */
+class DavRequestScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DavRequestScheduler(QObject *parent = nullptr);
+    ~DavRequestScheduler();
+
+    /**
+     * Returns the origin of @p url, i.e. its scheme, host and port.
+     */
+    static QString origin(const QUrl &url);
+
+    void setMaxRequestsPerOrigin(int max);
+    int maxRequestsPerOrigin() const;
+
+    /**
+     * Queues the request of @p job, which is sent as soon as its origin
+     * has a free slot.
+     */
+    void enqueue(DavJob *job);
+
+    /**
+     * Returns the number of requests waiting to be sent, to the origin of
+     * @p url or in total if @p url is empty.
+     */
+    int queuedRequestCount(const QUrl &url) const;
+
+    /**
+     * Returns the number of requests that have been sent and are not
+     * finished yet, to the origin of @p url or in total if @p url is empty.
+     */
+    int runningRequestCount(const QUrl &url) const;
+
+    /**
+     * Returns the average time in milliseconds the sent requests have
+     * spent in the queue.
+     */
+    qint64 averageWaitTime() const;
+
+    /**
+     * Returns the longest time in milliseconds a sent request has spent
+     * in the queue.
+     */
+    qint64 maxWaitTime() const;
+
+private Q_SLOTS:
+    void dispatch();
+
+private:
+    struct Origin {
+        QList<QPointer<DavJob>> queue;
+        QSet<QObject *> running;
+    };
+
+    void scheduleDispatch();
+    void requestDone(const QString &origin, QObject *job);
+
+    QHash<QString, Origin> mOrigins;
+    int mMaxRequestsPerOrigin;
+    bool mDispatchScheduled = false;
+    qint64 mTotalWaitTime = 0;
+    qint64 mMaxWaitTime = 0;
+    qint64 mSentCount = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,151 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#include "davretrypolicy.h"
+
+#include <QtCore/QList>
+#include <QtCore/QLocale>
+#include <QtCore/QtMath>
+
+#include <random>
+
+using namespace KDAV2;
+
+DavRetryPolicy::DavRetryPolicy()
+    : mMaxRetries(3)
+    , mInitialDelay(1000)
+    , mBackoffFactor(2.0)
+    , mMaxDelay(30000)
+    , mJitter(0.25)
+{
+}
+
+DavRetryPolicy DavRetryPolicy::noRetries()
+{
+    DavRetryPolicy policy;
+    policy.setMaxRetries(0);
+    return policy;
+}
+
+void DavRetryPolicy::setMaxRetries(int retries)
+{
+    mMaxRetries = qMax(0, retries);
+}
+
+int DavRetryPolicy::maxRetries() const
+{
+    return mMaxRetries;
+}
+
+void DavRetryPolicy::setInitialDelay(int msecs)
+{
+    mInitialDelay = qMax(0, msecs);
+}
+
+int DavRetryPolicy::initialDelay() const
+{
+    return mInitialDelay;
+}
+
+void DavRetryPolicy::setBackoffFactor(double factor)
+{
+    mBackoffFactor = qMax(1.0, factor);
+}
+
+double DavRetryPolicy::backoffFactor() const
+{
+    return mBackoffFactor;
+}
+
+void DavRetryPolicy::setMaxDelay(int msecs)
+{
+    mMaxDelay = qMax(0, msecs);
+}
+
+int DavRetryPolicy::maxDelay() const
+{
+    return mMaxDelay;
+}
+
+void DavRetryPolicy::setJitter(double fraction)
+{
+    mJitter = qBound(0.0, fraction, 1.0);
+}
+
+double DavRetryPolicy::jitter() const
+{
+    return mJitter;
+}
+
+int DavRetryPolicy::delay(int retry) const
+{
+    const double backoff = qMin<double>(mMaxDelay, mInitialDelay * qPow(mBackoffFactor, qMax(0, retry - 1)));
+    // A random factor between 1 - jitter and 1 + jitter. qrand() would need
+    // to be seeded in every thread, otherwise all clients draw the same spread.
+    static thread_local std::mt19937 generator(std::random_device{}());
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    const double spread = 1.0 + mJitter * distribution(generator);
+    return qBound(0, qRound(backoff * spread), mMaxDelay);
+}
+
+bool DavRetryPolicy::isTransientStatus(int httpStatusCode)
+{
+    switch (httpStatusCode) {
+        case 429: // Too many requests
+        case 502: // Bad gateway
+        case 503: // Service unavailable
+        case 504: // Gateway timeout
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool DavRetryPolicy::isIdempotent(const QByteArray &verb)
+{
+    // See RFC 7231, section 4.2.2, and RFC 4918
+    static const QList<QByteArray> idempotentVerbs = {
+        "GET", "HEAD", "OPTIONS", "PUT", "DELETE", "PROPFIND", "REPORT"
+    };
+    return idempotentVerbs.contains(verb.toUpper());
+}
+
+qint64 DavRetryPolicy::parseRetryAfter(const QByteArray &value, const QDateTime &now)
+{
+    const QByteArray trimmed = value.trimmed();
+    if (trimmed.isEmpty()) {
+        return -1;
+    }
+
+    bool ok = false;
+    const qint64 seconds = trimmed.toLongLong(&ok);
+    if (ok) {
+        return seconds >= 0 ? seconds * 1000 : -1;
+    }
+
+    // e.g. "Fri, 31 Dec 1999 23:59:59 GMT" (RFC 7231, section 7.1.1.1)
+    QString date = QString::fromLatin1(trimmed);
+    date.remove(QStringLiteral(" GMT"));
+    QDateTime dateTime = QLocale::c().toDateTime(date, QStringLiteral("ddd, dd MMM yyyy hh:mm:ss"));
+    if (!dateTime.isValid()) {
+        return -1;
+    }
+    dateTime.setTimeSpec(Qt::UTC);
+    return qMax<qint64>(0, now.msecsTo(dateTime));
+}
@@ -0,0 +1,125 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef KDAV2_DAVRETRYPOLICY_H
+#define KDAV2_DAVRETRYPOLICY_H
+
+#include "kpimkdav2_export.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDateTime>
+
+namespace KDAV2
+{
+
+/**
+ * @short Describes how failed requests are retried.
+ *
+ * Idempotent requests that fail with a transient error, i.e. with
+ * 429 (Too Many Requests), 502 (Bad Gateway), 503 (Service Unavailable),
+ * 504 (Gateway Timeout) or because the connection has been closed by the
+ * server, are sent again after a delay.
+ *
+ * The delay grows exponentially with every attempt, starting at
+ * initialDelay() and multiplied by backoffFactor() up to maxDelay(), and
+ * is randomly spread by jitter() so that clients don't come back all at
+ * the same time. A Retry-After header sent by the server takes precedence;
+ * if it asks to wait longer than maxDelay() the request is not retried.
+ */
+class KPIMKDAV2_EXPORT DavRetryPolicy
+{
+public:
+    /**
+     * Creates a policy that retries a request up to 3 times, after
+     * 1, 2 and 4 seconds, give or take 25 %.
+     */
+    DavRetryPolicy();
+
+    /**
+     * Returns a policy that never retries a request.
+     */
+    static DavRetryPolicy noRetries();
+
+    /**
+     * Sets the maximum number of times a request is sent again.
+     */
+    void setMaxRetries(int retries);
+    int maxRetries() const;
+
+    /**
+     * Sets the delay in milliseconds before the first retry.
+     */
+    void setInitialDelay(int msecs);
+    int initialDelay() const;
+
+    /**
+     * Sets the factor the delay is multiplied with after every retry.
+     */
+    void setBackoffFactor(double factor);
+    double backoffFactor() const;
+
+    /**
+     * Sets the maximum delay in milliseconds before a retry.
+     */
+    void setMaxDelay(int msecs);
+    int maxDelay() const;
+
+    /**
+     * Sets the fraction of the delay by which it is randomly lengthened or
+     * shortened, between 0 and 1.
+     */
+    void setJitter(double fraction);
+    double jitter() const;
+
+    /**
+     * Returns the delay in milliseconds before the retry number @p retry,
+     * counted from 1, with the jitter applied.
+     */
+    int delay(int retry) const;
+
+    /**
+     * Returns whether a request answered with @p httpStatusCode is worth
+     * retrying.
+     */
+    static bool isTransientStatus(int httpStatusCode);
+
+    /**
+     * Returns whether a request with the HTTP method @p verb can be sent
+     * again without changing the outcome.
+     */
+    static bool isIdempotent(const QByteArray &verb);
+
+    /**
+     * Parses the @p value of a Retry-After header, either in seconds or as
+     * a HTTP date, and returns the delay in milliseconds from @p now it
+     * asks for, or -1 if it can't be parsed.
+     */
+    static qint64 parseRetryAfter(const QByteArray &value, const QDateTime &now = QDateTime::currentDateTimeUtc());
+
+private:
+    int mMaxRetries;
+    int mInitialDelay;
+    double mBackoffFactor;
+    int mMaxDelay;
+    double mJitter;
+};
+
+}
+
+#endif
@@ -0,0 +1,496 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#include "davsession.h"
+
+#include "davcookiejar.h"
+#include "davjob.h"
+#include "davrequestscheduler.h"
+#include "davretrypolicy.h"
+#include "qwebdavlib/qwebdav.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QUrl>
+#include <QtXml/QDomDocument>
+
+using namespace KDAV2;
+
+struct DavSessionPrivate {
+    // Each session has its own network access manager so that sessions
+    // don't share connections, credentials or the authentication cache.
+    // The credentials found in the user info of a request url are stored
+    // in the request itself, so nothing is reconfigured per request.
+    QWebdav mWebDav;
+    DavItemCache *mItemCache = nullptr;
+    DavDiscoveryCache *mDiscoveryCache = nullptr;
+    DavCookieJar *mCookieJar = nullptr;
+    QHash<QString, DavSession::ServerQuirks> mServerQuirks;
+    QHash<QUrl, QString> mDiscoveryPaths;
+    QHash<QUrl, QUrl> mPrincipalUrls;
+    QHash<QPair<QUrl, int>, QStringList> mHomeSets;
+    DavRetryPolicy mRetryPolicy;
+    bool mBackgroundParsing = true;
+    // Declared after the network access manager, so that no queued
+    // request gets sent while the session is destroyed.
+    DavRequestScheduler mScheduler;
+
+    // The permanent redirects, oldest first
+    QHash<QString, QUrl> mRedirects;
+    QList<QString> mRedirectOrder;
+    int mMaxRedirects = 256;
+
+    void addRedirect(const QUrl &from, const QUrl &to);
+    void removeRedirect(const QUrl &from);
+    QUrl redirectTarget(const QUrl &url) const;
+
+    DavJob *createJob(const QUrl &url, const std::function<QNetworkReply *(const QUrl &)> &sendRequest);
+};
+
+static QString redirectKey(const QUrl &url)
+{
+    return url.adjusted(QUrl::RemoveUserInfo | QUrl::RemoveFragment).toString();
+}
+
+void DavSessionPrivate::addRedirect(const QUrl &from, const QUrl &to)
+{
+    const QString key = redirectKey(from);
+    if (key == redirectKey(to)) {
+        return;
+    }
+
+    if (!mRedirects.contains(key)) {
+        mRedirectOrder << key;
+    }
+    mRedirects.insert(key, to.adjusted(QUrl::RemoveUserInfo));
+    while (mRedirectOrder.size() > mMaxRedirects) {
+        mRedirects.remove(mRedirectOrder.takeFirst());
+    }
+}
+
+void DavSessionPrivate::removeRedirect(const QUrl &from)
+{
+    const QString key = redirectKey(from);
+    if (mRedirects.remove(key)) {
+        mRedirectOrder.removeOne(key);
+    }
+}
+
+QUrl DavSessionPrivate::redirectTarget(const QUrl &url) const
+{
+    QUrl target = url;
+    // Follow chains of redirects, but don't get caught in a loop
+    for (int hops = 0; hops < 5; ++hops) {
+        const auto it = mRedirects.constFind(redirectKey(target));
+        if (it == mRedirects.constEnd()) {
+            break;
+        }
+        target = *it;
+    }
+
+    // The credentials follow the redirect like in DavJob, they are only
+    // sent to another server once it asks for them
+    if (target != url) {
+        target.setUserName(url.userName());
+        target.setPassword(url.password());
+    }
+    return target;
+}
+
+DavJob *DavSessionPrivate::createJob(const QUrl &url, const std::function<QNetworkReply *(const QUrl &)> &sendRequest)
+{
+    // Resolve the redirects when the request is sent, so that it profits
+    // from those that are found while it waits in the queue
+    auto redirected = std::make_shared<bool>(false);
+    auto job = new DavJob{[this, url, sendRequest, redirected] {
+        const QUrl target = redirectTarget(url);
+        *redirected = target != url;
+        return sendRequest(target);
+    }, url};
+    job->setRetryPolicy(mRetryPolicy);
+    job->setBackgroundParsing(mBackgroundParsing);
+
+    QObject::connect(job, &DavJob::permanentlyRedirected, &mWebDav, [this] (const QUrl &from, const QUrl &to) {
+        addRedirect(from, to);
+    });
+    QObject::connect(job, &KJob::result, &mWebDav, [this, url, redirected] (KJob *job) {
+        // Forget a redirect that leads nowhere or to a server that doesn't
+        // let us in, the next request goes to the original url again
+        const int statusCode = static_cast<DavJob *>(job)->httpStatusCode();
+        if (*redirected && job->error()
+            && (statusCode == 0 || statusCode == 401 || statusCode == 403 || statusCode == 404 || statusCode == 410)) {
+            removeRedirect(url);
+        }
+    });
+
+    mScheduler.enqueue(job);
+    return job;
+}
+
+DavSession::DavSession()
+    : d(std::unique_ptr<DavSessionPrivate>(new DavSessionPrivate()))
+{
+}
+
+DavSession::~DavSession()
+{
+}
+
+void DavSession::setCredentials(const QString &userName, const QString &password)
+{
+    d->mWebDav.setCredentials(userName, password);
+}
+
+QString DavSession::userName() const
+{
+    return d->mWebDav.username();
+}
+
+QString DavSession::password() const
+{
+    return d->mWebDav.password();
+}
+
+void DavSession::setBearerToken(const QString &token)
+{
+    d->mWebDav.setBearerToken(token);
+}
+
+QString DavSession::bearerToken() const
+{
+    return d->mWebDav.bearerToken();
+}
+
+int DavSession::authenticationChallengeCount() const
+{
+    return d->mWebDav.authenticationChallengeCount();
+}
+
+void DavSession::setIgnoreSslErrors(bool ignore)
+{
+    d->mWebDav.setIgnoreSslErrors(ignore);
+}
+
+bool DavSession::ignoreSslErrors() const
+{
+    return d->mWebDav.ignoreSslErrors();
+}
+
+QNetworkAccessManager *DavSession::networkAccessManager() const
+{
+    return &d->mWebDav;
+}
+
+void DavSession::setCookieJar(DavCookieJar *jar)
+{
+    if (!jar) {
+        d->mWebDav.setCookieJar(new QNetworkCookieJar);
+        d->mCookieJar = nullptr;
+        return;
+    }
+
+    // The network access manager takes ownership of the jar, undo that
+    QObject *parent = jar->parent();
+    d->mWebDav.setCookieJar(jar);
+    jar->setParent(parent);
+    d->mCookieJar = jar;
+}
+
+DavCookieJar *DavSession::cookieJar() const
+{
+    return d->mCookieJar;
+}
+
+void DavSession::setItemCache(DavItemCache *cache)
+{
+    d->mItemCache = cache;
+}
+
+DavItemCache *DavSession::itemCache() const
+{
+    return d->mItemCache;
+}
+
+void DavSession::setDiscoveryCache(DavDiscoveryCache *cache)
+{
+    d->mDiscoveryCache = cache;
+}
+
+DavDiscoveryCache *DavSession::discoveryCache() const
+{
+    return d->mDiscoveryCache;
+}
+
+void DavSession::addServerQuirk(const QUrl &url, ServerQuirk quirk)
+{
+    d->mServerQuirks[DavRequestScheduler::origin(url)] |= quirk;
+}
+
+void DavSession::removeServerQuirk(const QUrl &url, ServerQuirk quirk)
+{
+    const QString origin = DavRequestScheduler::origin(url);
+    auto it = d->mServerQuirks.find(origin);
+    if (it == d->mServerQuirks.end()) {
+        return;
+    }
+    *it &= ~ServerQuirks(quirk);
+    if (*it == NoQuirks) {
+        d->mServerQuirks.erase(it);
+    }
+}
+
+DavSession::ServerQuirks DavSession::serverQuirks(const QUrl &url) const
+{
+    return d->mServerQuirks.value(DavRequestScheduler::origin(url));
+}
+
+void DavSession::setDiscoveryPath(const QUrl &wellKnownUrl, const QString &path)
+{
+    const QUrl key = wellKnownUrl.adjusted(QUrl::RemoveUserInfo | QUrl::RemoveFragment);
+    if (path.isEmpty()) {
+        d->mDiscoveryPaths.remove(key);
+    } else {
+        d->mDiscoveryPaths.insert(key, path);
+    }
+}
+
+QString DavSession::discoveryPath(const QUrl &wellKnownUrl) const
+{
+    return d->mDiscoveryPaths.value(wellKnownUrl.adjusted(QUrl::RemoveUserInfo | QUrl::RemoveFragment));
+}
+
+// The user name tells the accounts on the same server apart
+static QUrl accountKey(const QUrl &url)
+{
+    return url.adjusted(QUrl::RemovePassword | QUrl::RemoveFragment);
+}
+
+void DavSession::setPrincipalUrl(const QUrl &url, const QUrl &principalUrl)
+{
+    const QUrl key = accountKey(url);
+    if (principalUrl.isValid()) {
+        d->mPrincipalUrls.insert(key, principalUrl.adjusted(QUrl::RemoveUserInfo | QUrl::RemoveFragment));
+    } else {
+        d->mPrincipalUrls.remove(key);
+    }
+}
+
+QUrl DavSession::principalUrl(const QUrl &url) const
+{
+    QUrl principalUrl = d->mPrincipalUrls.value(accountKey(url));
+    if (principalUrl.isValid()) {
+        principalUrl.setUserName(url.userName());
+        principalUrl.setPassword(url.password());
+    }
+    return principalUrl;
+}
+
+void DavSession::setHomeSets(const QUrl &principalUrl, Protocol protocol, const QStringList &homeSets)
+{
+    const auto key = qMakePair(accountKey(principalUrl), static_cast<int>(protocol));
+    if (homeSets.isEmpty()) {
+        d->mHomeSets.remove(key);
+    } else {
+        d->mHomeSets.insert(key, homeSets);
+    }
+}
+
+QStringList DavSession::homeSets(const QUrl &principalUrl, Protocol protocol) const
+{
+    return d->mHomeSets.value(qMakePair(accountKey(principalUrl), static_cast<int>(protocol)));
+}
+
+void DavSession::setRetryPolicy(const DavRetryPolicy &policy)
+{
+    d->mRetryPolicy = policy;
+}
+
+DavRetryPolicy DavSession::retryPolicy() const
+{
+    return d->mRetryPolicy;
+}
+
+void DavSession::setBackgroundParsing(bool background)
+{
+    d->mBackgroundParsing = background;
+}
+
+bool DavSession::backgroundParsing() const
+{
+    return d->mBackgroundParsing;
+}
+
+void DavSession::setMaxRequestsPerHost(int max)
+{
+    d->mScheduler.setMaxRequestsPerOrigin(max);
+}
+
+int DavSession::maxRequestsPerHost() const
+{
+    return d->mScheduler.maxRequestsPerOrigin();
+}
+
+int DavSession::queuedRequestCount(const QUrl &url) const
+{
+    return d->mScheduler.queuedRequestCount(url);
+}
+
+int DavSession::runningRequestCount(const QUrl &url) const
+{
+    return d->mScheduler.runningRequestCount(url);
+}
+
+qint64 DavSession::averageQueueWaitTime() const
+{
+    return d->mScheduler.averageWaitTime();
+}
+
+qint64 DavSession::maxQueueWaitTime() const
+{
+    return d->mScheduler.maxWaitTime();
+}
+
+void DavSession::addRedirect(const QUrl &from, const QUrl &to)
+{
+    d->addRedirect(from, to);
+}
+
+void DavSession::removeRedirect(const QUrl &from)
+{
+    d->removeRedirect(from);
+}
+
+QUrl DavSession::redirectTarget(const QUrl &url) const
+{
+    return d->redirectTarget(url);
+}
+
+void DavSession::clearRedirects()
+{
+    d->mRedirects.clear();
+    d->mRedirectOrder.clear();
+}
+
+void DavSession::setMaxCachedRedirects(int max)
+{
+    d->mMaxRedirects = qMax(0, max);
+    while (d->mRedirectOrder.size() > d->mMaxRedirects) {
+        d->mRedirects.remove(d->mRedirectOrder.takeFirst());
+    }
+}
+
+int DavSession::maxCachedRedirects() const
+{
+    return d->mMaxRedirects;
+}
+
+DavJob *DavSession::createPropFindJob(const QUrl &url, const QDomDocument &document, const QString &depth)
+{
+    const QByteArray query = document.toByteArray();
+    const int depthValue = depth.toInt();
+    auto webDav = &d->mWebDav;
+    return d->createJob(url, [=] (const QUrl &target) {
+        return webDav->propfind(target, query, depthValue);
+    });
+}
+
+DavJob *DavSession::createReportJob(const QUrl &url, const QDomDocument &document, const QString &depth)
+{
+    const QByteArray query = document.toByteArray();
+    const int depthValue = depth.toInt();
+    auto webDav = &d->mWebDav;
+    return d->createJob(url, [=] (const QUrl &target) {
+        return webDav->report(target, query, depthValue);
+    });
+}
+
+DavJob *DavSession::createDeleteJob(const QUrl &url)
+{
+    auto webDav = &d->mWebDav;
+    return d->createJob(url, [=] (const QUrl &target) {
+        return webDav->remove(target);
+    });
+}
+
+DavJob *DavSession::createGetJob(const QUrl &url, const QByteArray &etag)
+{
+    // Work around a strange bug in Zimbra (seen at least on CE 5.0.18) : if the user-agent
+    // contains "Mozilla", some strange debug data is displayed in the shared calendars.
+    // This kinda mess up the events parsing...
+    QMap<QByteArray, QByteArray> headers{{"User-Agent", "KDAV2"}};
+    if (!etag.isEmpty()) {
+        headers.insert("If-None-Match", etag);
+    }
+    auto webDav = &d->mWebDav;
+    return d->createJob(url, [=] (const QUrl &target) {
+        return webDav->get(target, headers);
+    });
+}
+
+DavJob *DavSession::createPropPatchJob(const QUrl &url, const QDomDocument &document)
+{
+    const QByteArray query = document.toByteArray();
+    auto webDav = &d->mWebDav;
+    return d->createJob(url, [=] (const QUrl &target) {
+        return webDav->proppatch(target, query);
+    });
+}
+
+DavJob *DavSession::createCreateJob(const QByteArray &data, const QUrl &url, const QByteArray &contentType)
+{
+    auto webDav = &d->mWebDav;
+    return d->createJob(url, [=] (const QUrl &target) {
+        return webDav->put(target, data, {{"Content-Type", contentType}, {"If-None-Match", "*"}});
+    });
+}
+
+DavJob *DavSession::createModifyJob(const QByteArray &data, const QUrl &url, const QByteArray &contentType, const QByteArray &etag)
+{
+    auto webDav = &d->mWebDav;
+    return d->createJob(url, [=] (const QUrl &target) {
+        return webDav->put(target, data, {{"Content-Type", contentType}, {"If-Match", etag}});
+    });
+}
+
+DavJob *DavSession::createMkColJob(const QUrl &url)
+{
+    auto webDav = &d->mWebDav;
+    return d->createJob(url, [=] (const QUrl &target) {
+        return webDav->mkdir(target);
+    });
+}
+
+DavJob *DavSession::createMkColJob(const QUrl &url, const QDomDocument &document)
+{
+    const QByteArray query = document.toByteArray();
+    auto webDav = &d->mWebDav;
+    return d->createJob(url, [=] (const QUrl &target) {
+        return webDav->mkdir(target, query);
+    });
+}
+
+DavJob *DavSession::createMkCalendarJob(const QUrl &url, const QDomDocument &document)
+{
+    const QByteArray query = document.toByteArray();
+    auto webDav = &d->mWebDav;
+    return d->createJob(url, [=] (const QUrl &target) {
+        return webDav->mkcalendar(target, query);
+    });
+}
@@ -0,0 +1,464 @@
+/*
+    Copyright (c) 2026 agent <agent@local>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef KDAV2_DAVSESSION_H
+#define KDAV2_DAVSESSION_H
+
+#include "kpimkdav2_export.h"
+
+#include "enums.h"
+
+#include <memory>
+
+#include <QtCore/QFlags>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QUrl>
+
+class QDomDocument;
+class QNetworkAccessManager;
+
+struct DavSessionPrivate;
+
+namespace KDAV2
+{
+
+class DavCookieJar;
+class DavDiscoveryCache;
+class DavItemCache;
+class DavJob;
+class DavRetryPolicy;
+
+/**
+ * @short The HTTP session used to talk to a DAV server.
+ *
+ * A session owns its own network access manager, and with it its own
+ * connections, TLS state and authentication cache, as well as the
+ * credentials used to answer authentication challenges. Using a session
+ * per account allows to run jobs for several accounts at the same time
+ * without them sharing any state.
+ *
+ * The low-level DAV jobs are created by the factory methods of this class,
+ * the high-level jobs use the session set with DavJobBase::setSession().
+ * The requests of the low-level jobs are queued per host and sent in the
+ * order of their priority, with at most maxRequestsPerHost() requests to
+ * the same host at a time.
+ *
+ * @note The session must outlive all the jobs that use it.
+ */
+class KPIMKDAV2_EXPORT DavSession
+{
+public:
+    /**
+     * Describes a deviation of a server from the usual behavior, that the
+     * jobs work around.
+     */
+    enum ServerQuirk {
+        NoQuirks = 0,
+        NoCTagInListing = 1 ///< The CTags are missing when listing a home set.
+    };
+    Q_DECLARE_FLAGS(ServerQuirks, ServerQuirk)
+
+    /**
+     * Creates a new session.
+     */
+    DavSession();
+
+    /**
+     * Destroys the session, aborting all its pending requests.
+     */
+    ~DavSession();
+
+    /**
+     * Sets the credentials used for the requests whose url doesn't
+     * contain any user info.
+     */
+    void setCredentials(const QString &userName, const QString &password);
+
+    /**
+     * Returns the user name set with setCredentials().
+     */
+    QString userName() const;
+
+    /**
+     * Returns the password set with setCredentials().
+     */
+    QString password() const;
+
+    /**
+     * Sets an OAuth @p token, that is sent in a Bearer Authorization header
+     * with every request whose url doesn't contain any user info.
+     */
+    void setBearerToken(const QString &token);
+
+    /**
+     * Returns the token set with setBearerToken().
+     */
+    QString bearerToken() const;
+
+    /**
+     * Returns the number of authentication challenges (401 responses) the
+     * session has answered so far.
+     *
+     * Once a server over https has challenged a request, Basic credentials
+     * are sent along with the following requests to it right away, so this
+     * should stay close to one per server.
+     */
+    int authenticationChallengeCount() const;
+
+    /**
+     * Ignore all ssl errors.
+     *
+     * If you want to handle ssl errors yourself via the networkAccessManager, then set to false.
+     *
+     * Enabled by default.
+     */
+    void setIgnoreSslErrors(bool ignore);
+
+    /**
+     * Returns whether ssl errors are ignored.
+     */
+    bool ignoreSslErrors() const;
+
+    /**
+     * Provides access to the network access manager of this session.
+     */
+    QNetworkAccessManager *networkAccessManager() const;
+
+    /**
+     * Sets the @p jar that keeps the cookies set by the servers and sends
+     * them back with the following requests.
+     *
+     * Servers that hand out a session cookie can then authenticate the
+     * requests with it instead of verifying the credentials every time.
+     * No credentials are sent unasked along with a cookie; if the server
+     * rejects the cookie, its challenge is answered as usual.
+     *
+     * The session does not take ownership of the jar, which must outlive
+     * it and may be shared by several sessions. Pass nullptr to go back to
+     * the default, a jar that is owned by the session and kept in memory.
+     */
+    void setCookieJar(DavCookieJar *jar);
+
+    /**
+     * Returns the cookie jar set with setCookieJar(), if any.
+     */
+    DavCookieJar *cookieJar() const;
+
+    /**
+     * Sets the @p cache that item fetch jobs use to avoid downloading
+     * unmodified items again.
+     *
+     * The session does not take ownership of the cache, which must outlive
+     * it. Pass nullptr to disable caching, which is the default.
+     */
+    void setItemCache(DavItemCache *cache);
+
+    /**
+     * Returns the item cache of this session, if any.
+     */
+    DavItemCache *itemCache() const;
+
+    /**
+     * Sets the @p cache that discovery jobs use to skip the requests for
+     * the principal urls and home sets they already know.
+     *
+     * The session does not take ownership of the cache, which must outlive
+     * it. Pass nullptr to disable caching, which is the default.
+     */
+    void setDiscoveryCache(DavDiscoveryCache *cache);
+
+    /**
+     * Returns the discovery cache of this session, if any.
+     */
+    DavDiscoveryCache *discoveryCache() const;
+
+    /**
+     * Remembers that the server at @p url shows the given @p quirk, so that
+     * later jobs can work around it right away.
+     *
+     * The quirks are stored per scheme, host and port.
+     */
+    void addServerQuirk(const QUrl &url, ServerQuirk quirk);
+
+    /**
+     * Forgets the given @p quirk of the server at @p url, once it has been
+     * seen behaving as usual again.
+     */
+    void removeServerQuirk(const QUrl &url, ServerQuirk quirk);
+
+    /**
+     * Returns the quirks that have been seen from the server at @p url.
+     */
+    ServerQuirks serverQuirks(const QUrl &url) const;
+
+    /**
+     * Remembers that the discovery starting at @p wellKnownUrl found the
+     * principal with a request to @p path, so that later discoveries can
+     * send that request only.
+     *
+     * Pass an empty @p path to forget it.
+     *
+     * @see DavDiscoveryJob::setParallelDiscovery()
+     */
+    void setDiscoveryPath(const QUrl &wellKnownUrl, const QString &path);
+
+    /**
+     * Returns the path that found the principal for the discovery starting
+     * at @p wellKnownUrl, or an empty string if it is not known.
+     */
+    QString discoveryPath(const QUrl &wellKnownUrl) const;
+
+    /**
+     * Remembers that the principal of the user at @p url is
+     * @p principalUrl, so that the discovery and home set jobs don't ask
+     * the server for it again. The user name of @p url is part of the key.
+     *
+     * Pass an invalid @p principalUrl to forget it.
+     */
+    void setPrincipalUrl(const QUrl &url, const QUrl &principalUrl);
+
+    /**
+     * Returns the principal url known for @p url, with the user info of
+     * @p url, or an invalid url if it is not known.
+     */
+    QUrl principalUrl(const QUrl &url) const;
+
+    /**
+     * Remembers the @p homeSets of the given @p protocol found on the
+     * principal at @p principalUrl. The user name of @p principalUrl is
+     * part of the key.
+     *
+     * Pass an empty list to forget them.
+     */
+    void setHomeSets(const QUrl &principalUrl, Protocol protocol, const QStringList &homeSets);
+
+    /**
+     * Returns the home sets of the given @p protocol known for the
+     * principal at @p principalUrl.
+     */
+    QStringList homeSets(const QUrl &principalUrl, Protocol protocol) const;
+
+    /**
+     * Sets the @p policy used to retry the requests that fail with a
+     * transient error, e.g. because the server is overloaded.
+     *
+     * By default idempotent requests are retried up to 3 times.
+     * Use DavRetryPolicy::noRetries() to disable retrying.
+     */
+    void setRetryPolicy(const DavRetryPolicy &policy);
+
+    /**
+     * Returns the retry policy of this session.
+     */
+    DavRetryPolicy retryPolicy() const;
+
+    /**
+     * Sets whether the responses to the requests of this session are
+     * parsed in the global thread pool, keeping large responses from
+     * blocking the thread the jobs run in. Enabled by default.
+     *
+     * @see DavJob::setBackgroundParsing()
+     */
+    void setBackgroundParsing(bool background);
+
+    /**
+     * Returns whether the responses are parsed in the thread pool.
+     */
+    bool backgroundParsing() const;
+
+    /**
+     * Sets the maximum number of requests that are sent at the same time
+     * to the same scheme, host and port.
+     *
+     * The default is 6, the number of connections the network access
+     * manager opens per host.
+     */
+    void setMaxRequestsPerHost(int max);
+
+    /**
+     * Returns the maximum number of concurrent requests per host.
+     */
+    int maxRequestsPerHost() const;
+
+    /**
+     * Returns the number of requests that wait to be sent to the host of
+     * @p url, or to any host if @p url is empty.
+     */
+    int queuedRequestCount(const QUrl &url = QUrl()) const;
+
+    /**
+     * Returns the number of requests that have been sent to the host of
+     * @p url, or to any host if @p url is empty, and haven't finished yet.
+     */
+    int runningRequestCount(const QUrl &url = QUrl()) const;
+
+    /**
+     * Returns the average time in milliseconds the requests sent so far
+     * have waited in the queue.
+     */
+    qint64 averageQueueWaitTime() const;
+
+    /**
+     * Returns the longest time in milliseconds a request sent so far has
+     * waited in the queue.
+     */
+    qint64 maxQueueWaitTime() const;
+
+    /**
+     * Remembers that the resource at @p from has moved to @p to, so that
+     * the requests to @p from are sent to @p to right away.
+     *
+     * The permanent redirects (301 and 308) the servers answer with are
+     * remembered automatically. A redirect is forgotten again when a
+     * request sent to its target fails with 401, 403, 404, 410 or a
+     * network error.
+     *
+     * The user info of the requested url is carried over to the target,
+     * also if it is on another server. As with redirects followed by a
+     * request, the credentials are not sent to another server before it
+     * asks for them.
+     */
+    void addRedirect(const QUrl &from, const QUrl &to);
+
+    /**
+     * Forgets the redirect from @p from.
+     */
+    void removeRedirect(const QUrl &from);
+
+    /**
+     * Returns the url the requests to @p url are sent to, i.e. @p url
+     * itself if it hasn't been redirected.
+     */
+    QUrl redirectTarget(const QUrl &url) const;
+
+    /**
+     * Forgets all the redirects.
+     */
+    void clearRedirects();
+
+    /**
+     * Sets the maximum number of redirects that are remembered, the oldest
+     * ones are forgotten first. The default is 256.
+     */
+    void setMaxCachedRedirects(int max);
+
+    /**
+     * Returns the maximum number of redirects that are remembered.
+     */
+    int maxCachedRedirects() const;
+
+    /**
+     * Returns a preconfigured DAV PROPFIND job.
+     *
+     * @param url The target url of the job.
+     * @param document The query XML document.
+     * @param depth The Depth: value to send in the HTTP request
+     */
+    DavJob *createPropFindJob(const QUrl &url, const QDomDocument &document, const QString &depth = QStringLiteral("1"));
+
+    /**
+     * Returns a preconfigured DAV GET job.
+     *
+     * If @p etag is set, it is sent in a If-None-Match header, and the
+     * server answers with 304 (Not Modified) if the entity still matches it.
+     *
+     * @param url The target url of the job.
+     * @param etag The etag of a copy of the entity the caller already has.
+     */
+    DavJob *createGetJob(const QUrl &url, const QByteArray &etag = QByteArray());
+
+    /**
+     * Returns a preconfigured DAV DELETE job.
+     *
+     * @param url The target url of the job.
+     */
+    DavJob *createDeleteJob(const QUrl &url);
+
+    /**
+     * Returns a preconfigured DAV PUT job with a If-None-Match header.
+     *
+     * @param data The data to PUT.
+     * @param url The target url of the job.
+     * @param contentType The content-type.
+     */
+    DavJob *createCreateJob(const QByteArray &data, const QUrl &url, const QByteArray &contentType);
+
+    /**
+     * Returns a preconfigured DAV PUT job with a If-Match header, that matches the @param etag.
+     *
+     * @param data The data to PUT.
+     * @param url The target url of the job.
+     * @param contentType The content-type.
+     * @param etag The etag of the entity to modify.
+     */
+    DavJob *createModifyJob(const QByteArray &data, const QUrl &url, const QByteArray &contentType, const QByteArray &etag);
+
+    /**
+     * Returns a preconfigured DAV REPORT job.
+     *
+     * @param url The target url of the job.
+     * @param document The query XML document.
+     * @param depth The Depth: value to send in the HTTP request
+     */
+    DavJob *createReportJob(const QUrl &url, const QDomDocument &document, const QString &depth = QStringLiteral("1"));
+
+    /**
+     * Returns a preconfigured DAV PROPPATCH job.
+     *
+     * @param url The target url of the job.
+     * @param document The query XML document.
+     */
+    DavJob *createPropPatchJob(const QUrl &url, const QDomDocument &document);
+
+    /**
+     * Returns a preconfigured DAV MKCOL job.
+     *
+     * @param url The url to MKCOL (may be empty).
+     */
+    DavJob *createMkColJob(const QUrl &url);
+
+    /**
+     * Returns a preconfigured extended CardDAV MKCOL job.
+     *
+     * @param url The url to MKCOL (may be empty).
+     * @param document The query of the extended MKCOL request
+     */
+    DavJob *createMkColJob(const QUrl &url, const QDomDocument &document);
+
+    /**
+     * Returns a preconfigured DAV MKCALENDAR job.
+     *
+     * @param url The url of the new calendar
+     * @param document The query of the MKCALENDAR request
+     */
+    DavJob *createMkCalendarJob(const QUrl &url, const QDomDocument &document);
+
+private:
+    DavSession(const DavSession &) = delete;
+    DavSession &operator=(const DavSession &) = delete;
+
+    std::unique_ptr<DavSessionPrivate> d;
+};
+
+}
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(KDAV2::DavSession::ServerQuirks)
+
+#endif
@@ -23,39 +23,58 @@
 
 using namespace KDAV2;
 
+class DavUrlPrivate : public QSharedData
+{
+public:
+    QUrl mUrl;
+    Protocol mProtocol = KDAV2::CalDav;
+};
+
 DavUrl::DavUrl()
-    : mProtocol(KDAV2::CalDav)
+    : d(new DavUrlPrivate)
 {
 }
 
 DavUrl::DavUrl(const QUrl &url, Protocol protocol)
-    : mUrl(url), mProtocol(protocol)
+    : d(new DavUrlPrivate)
 {
+    d->mUrl = url;
+    d->mProtocol = protocol;
 }
 
+DavUrl::DavUrl(const DavUrl &other) = default;
+
+DavUrl::DavUrl(DavUrl &&other) noexcept = default;
+
+DavUrl &DavUrl::operator=(const DavUrl &other) = default;
+
+DavUrl &DavUrl::operator=(DavUrl &&other) noexcept = default;
+
+DavUrl::~DavUrl() = default;
+
 void DavUrl::setUrl(const QUrl &url)
 {
-    mUrl = url;
+    d->mUrl = url;
 }
 
 QUrl DavUrl::url() const
 {
-    return mUrl;
+    return d->mUrl;
 }
 
 void DavUrl::setProtocol(Protocol protocol)
 {
-    mProtocol = protocol;
+    d->mProtocol = protocol;
 }
 
 Protocol DavUrl::protocol() const
 {
-    return mProtocol;
+    return d->mProtocol;
 }
 
 QString DavUrl::toDisplayString() const
 {
-    auto url = mUrl;
+    auto url = d->mUrl;
     url.setUserInfo(QString());
     return url.toDisplayString();
 }
@@ -23,9 +23,12 @@
 
 #include "enums.h"
 
+#include <QtCore/QSharedDataPointer>
 #include <QtCore/QUrl>
 #include <QtCore/QVector>
 
+class DavUrlPrivate;
+
 namespace KDAV2
 {
 
@@ -53,6 +56,18 @@ public:
      */
     DavUrl(const QUrl &url, Protocol protocol);
 
+    /**
+     * Creates a shallow copy of @p other.
+     *
+     * The data is implicitly shared and only detached on the first write.
+     */
+    DavUrl(const DavUrl &other);
+    DavUrl(DavUrl &&other) noexcept;
+    DavUrl &operator=(const DavUrl &other);
+    DavUrl &operator=(DavUrl &&other) noexcept;
+
+    ~DavUrl();
+
     /**
      * Sets the @p url that identifies the DAV object.
      */
@@ -79,8 +94,7 @@ public:
     Protocol protocol() const;
 
 private:
-    QUrl mUrl;
-    Protocol mProtocol;
+    QSharedDataPointer<DavUrlPrivate> d;
 };
 
 KPIMKDAV2_EXPORT QDataStream &operator<<(QDataStream &out, const DavUrl &url);
@@ -54,6 +54,18 @@ enum Privilege {
 Q_DECLARE_FLAGS(Privileges, Privilege)
 Q_DECLARE_OPERATORS_FOR_FLAGS(Privileges)
 
+/**
+ * Describes how urgently the results of a job are needed.
+ *
+ * When the requests to a server have to wait for a free connection,
+ * the requests with the highest priority are sent first.
+ */
+enum Priority {
+    InteractivePriority = 0, ///< A user is waiting for the result
+    NormalPriority,          ///< The default priority
+    BackgroundPriority       ///< Bulk transfers, e.g. when synchronizing
+};
+
 }
 
 #endif
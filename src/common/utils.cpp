@@ -288,3 +288,43 @@ bool Utils::extractCollection(const QDomElement &response, DavUrl davUrl, DavCol
 
     return true;
 }
+
+bool Utils::isStrongETag(const QString &etag)
+{
+    return !etag.isEmpty() && !etag.startsWith(QLatin1String("W/"));
+}
+
+QDomDocument Utils::etagQuery()
+{
+    QDomDocument document;
+
+    QDomElement propfindElement = document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("propfind"));
+    document.appendChild(propfindElement);
+
+    QDomElement propElement = document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("prop"));
+    propfindElement.appendChild(propElement);
+
+    propElement.appendChild(document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("getetag")));
+
+    return document;
+}
+
+QString Utils::extractETag(const QDomDocument &document)
+{
+    const QDomNodeList etags = document.elementsByTagNameNS(QStringLiteral("DAV:"), QStringLiteral("getetag"));
+    if (etags.isEmpty()) {
+        return QString();
+    }
+
+    return etags.item(0).toElement().text().trimmed();
+}
+
+QString Utils::canonicalUrl(const QUrl &url)
+{
+    QUrl canonical = url.adjusted(QUrl::RemoveUserInfo | QUrl::RemoveFragment | QUrl::NormalizePathSegments | QUrl::StripTrailingSlash);
+    if ((canonical.scheme() == QLatin1String("http") && canonical.port() == 80)
+        || (canonical.scheme() == QLatin1String("https") && canonical.port() == 443)) {
+        canonical.setPort(-1);
+    }
+    return canonical.toString(QUrl::FullyDecoded);
+}
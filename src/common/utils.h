@@ -83,6 +83,32 @@ QString KPIMKDAV2_EXPORT contactsMimeType(Protocol protocol);
  * @return false if a collection could not be extracted.
  */
 bool extractCollection(const QDomElement &response, DavUrl url, DavCollection &collection);
+
+/**
+ * Returns whether @p etag is a strong entity tag.
+ *
+ * A server only returns a strong etag in the response to a PUT if it stored
+ * the sent data unchanged, so the etag is valid for the local copy as well.
+ */
+bool KPIMKDAV2_EXPORT isStrongETag(const QString &etag);
+
+/**
+ * Returns the query of a PROPFIND request for the DAV:getetag property only.
+ */
+QDomDocument KPIMKDAV2_EXPORT etagQuery();
+
+/**
+ * Returns the DAV:getetag property found in the multistatus @p document,
+ * or an empty string if there is none.
+ */
+QString KPIMKDAV2_EXPORT extractETag(const QDomDocument &document);
+
+/**
+ * Returns a key for @p url that is the same for all the spellings of the
+ * same resource, e.g. with or without the user info, the default port, a
+ * trailing slash or percent encoding.
+ */
+QString KPIMKDAV2_EXPORT canonicalUrl(const QUrl &url);
 }
 
 }
@@ -56,6 +56,34 @@ public:
     }
 };
 
+static QDomElement componentFilter(QDomDocument &document, const QString &typeFilter, const QString &startTime, const QString &endTime)
+{
+    QDomElement subcompfilterElement = document.createElementNS(QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("comp-filter"));
+    QDomAttr nameAttribute = document.createAttribute(QStringLiteral("name"));
+    nameAttribute.setValue(typeFilter);
+    subcompfilterElement.setAttributeNode(nameAttribute);
+
+    if (!startTime.isEmpty() || !endTime.isEmpty()) {
+        QDomElement timeRangeElement = document.createElementNS(QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("time-range"));
+
+        if (!startTime.isEmpty()) {
+            QDomAttr startAttribute = document.createAttribute(QStringLiteral("start"));
+            startAttribute.setValue(startTime);
+            timeRangeElement.setAttributeNode(startAttribute);
+        }
+
+        if (!endTime.isEmpty()) {
+            QDomAttr endAttribute = document.createAttribute(QStringLiteral("end"));
+            endAttribute.setValue(endTime);
+            timeRangeElement.setAttributeNode(endAttribute);
+        }
+
+        subcompfilterElement.appendChild(timeRangeElement);
+    }
+
+    return subcompfilterElement;
+}
+
 static QDomDocument listQuery(const QString &typeFilter, const QString startTime, const QString &endTime)
 {
     QDomDocument document;
@@ -82,29 +110,89 @@ static QDomDocument listQuery(const QString &typeFilter, const QString startTime
     compfilterElement.setAttributeNode(nameAttribute);
     filterElement.appendChild(compfilterElement);
 
-    QDomElement subcompfilterElement = document.createElementNS(QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("comp-filter"));
-    nameAttribute = document.createAttribute(QStringLiteral("name"));
-    nameAttribute.setValue(typeFilter);
-    subcompfilterElement.setAttributeNode(nameAttribute);
+    compfilterElement.appendChild(componentFilter(document, typeFilter, startTime, endTime));
 
-    if (!startTime.isEmpty() || !endTime.isEmpty()) {
-        QDomElement timeRangeElement = document.createElementNS(QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("time-range"));
+    return document;
+}
 
-        if (!startTime.isEmpty()) {
-            QDomAttr startAttribute = document.createAttribute(QStringLiteral("start"));
-            startAttribute.setValue(startTime);
-            timeRangeElement.setAttributeNode(startAttribute);
-        }
+static QDomDocument combinedListQuery(const QStringList &typeFilters, const QString &startTime, const QString &endTime)
+{
+    /*
+     * Create a query like this, the filter is omitted if all the
+     * components are listed without time range:
+     *
+     * <C:calendar-query xmlns:D="DAV:" xmlns:C="urn:ietf:params:xml:ns:caldav">
+     *   <D:prop>
+     *     <D:getetag/>
+     *     <D:resourcetype/>
+     *     <C:calendar-data>
+     *       <C:comp name="VCALENDAR">
+     *         <C:comp name="VEVENT"/>
+     *         <C:comp name="VTODO"/>
+     *       </C:comp>
+     *     </C:calendar-data>
+     *   </D:prop>
+     *   <C:filter>
+     *     <C:comp-filter name="VCALENDAR" test="anyof">
+     *       <C:comp-filter name="VEVENT">
+     *         <C:time-range start="20170101T000000Z"/>
+     *       </C:comp-filter>
+     *       <C:comp-filter name="VTODO">
+     *         <C:time-range start="20170101T000000Z"/>
+     *       </C:comp-filter>
+     *     </C:comp-filter>
+     *   </C:filter>
+     * </C:calendar-query>
+     *
+     * The calendar data only consists of the bare components, which is
+     * enough to tell the type of each item.
+     */
 
-        if (!endTime.isEmpty()) {
-            QDomAttr endAttribute = document.createAttribute(QStringLiteral("end"));
-            endAttribute.setValue(endTime);
-            timeRangeElement.setAttributeNode(endAttribute);
-        }
+    QDomDocument document;
 
-        subcompfilterElement.appendChild(timeRangeElement);
+    QDomElement queryElement = document.createElementNS(QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("calendar-query"));
+    document.appendChild(queryElement);
+
+    QDomElement propElement = document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("prop"));
+    queryElement.appendChild(propElement);
+
+    propElement.appendChild(document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("getetag")));
+    propElement.appendChild(document.createElementNS(QStringLiteral("DAV:"), QStringLiteral("resourcetype")));
+
+    QDomElement calendarDataElement = document.createElementNS(QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("calendar-data"));
+    propElement.appendChild(calendarDataElement);
+
+    QDomElement calendarCompElement = document.createElementNS(QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("comp"));
+    calendarCompElement.setAttribute(QStringLiteral("name"), QStringLiteral("VCALENDAR"));
+    calendarDataElement.appendChild(calendarCompElement);
+
+    for (const QString &typeFilter : typeFilters) {
+        QDomElement compElement = document.createElementNS(QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("comp"));
+        compElement.setAttribute(QStringLiteral("name"), typeFilter);
+        calendarCompElement.appendChild(compElement);
+    }
+
+    QDomElement filterElement = document.createElementNS(QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("filter"));
+    queryElement.appendChild(filterElement);
+
+    QDomElement compfilterElement = document.createElementNS(QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("comp-filter"));
+    compfilterElement.setAttribute(QStringLiteral("name"), QStringLiteral("VCALENDAR"));
+    filterElement.appendChild(compfilterElement);
+
+    const bool allTypes = typeFilters.contains(QStringLiteral("VEVENT"))
+                          && typeFilters.contains(QStringLiteral("VTODO"))
+                          && typeFilters.contains(QStringLiteral("VJOURNAL"));
+    if (allTypes && startTime.isEmpty() && endTime.isEmpty()) {
+        return document;
+    }
+
+    if (typeFilters.size() > 1) {
+        compfilterElement.setAttribute(QStringLiteral("test"), QStringLiteral("anyof"));
+    }
+
+    for (const QString &typeFilter : typeFilters) {
+        compfilterElement.appendChild(componentFilter(document, typeFilter, startTime, endTime));
     }
-    compfilterElement.appendChild(subcompfilterElement);
 
     return document;
 }
@@ -151,6 +239,20 @@ public:
     }
 };
 
+class CaldavListQueryBuilder : public XMLQueryBuilder
+{
+public:
+    QDomDocument buildQuery() const Q_DECL_OVERRIDE
+    {
+        return combinedListQuery(parameter(QStringLiteral("mimeTypes")).toStringList(), parameter(QStringLiteral("start")).toString(), parameter(QStringLiteral("end")).toString());
+    }
+
+    QString mimeType() const Q_DECL_OVERRIDE
+    {
+        return QString();
+    }
+};
+
 class CaldavMultigetQueryBuilder : public XMLQueryBuilder
 {
 public:
@@ -203,6 +305,11 @@ bool CaldavProtocol::supportsCTags() const
     return true;
 }
 
+bool CaldavProtocol::supportsSyncCollection() const
+{
+    return true;
+}
+
 bool CaldavProtocol::useReport() const
 {
     return true;
@@ -228,12 +335,13 @@ XMLQueryBuilder::Ptr CaldavProtocol::collectionsQuery() const
     return XMLQueryBuilder::Ptr(new CaldavCollectionQueryBuilder());
 }
 
-QString CaldavProtocol::collectionsXQuery() const
+QVector<QPair<QString, QString>> CaldavProtocol::collectionResourceTypes() const
 {
-    //const QString query( "//*[local-name()='calendar' and namespace-uri()='urn:ietf:params:xml:ns:caldav']/ancestor::*[local-name()='prop' and namespace-uri()='DAV:']/*[local-name()='supported-calendar-component-set' and namespace-uri()='urn:ietf:params:xml:ns:caldav']/*[local-name()='comp' and namespace-uri()='urn:ietf:params:xml:ns:caldav' and (@name='VTODO' or @name='VEVENT')]/ancestor::*[local-name()='response' and namespace-uri()='DAV:']" );
-    const QString query(QStringLiteral("//*[local-name()='calendar' and namespace-uri()='urn:ietf:params:xml:ns:caldav']/ancestor::*[local-name()='prop' and namespace-uri()='DAV:']/ancestor::*[local-name()='response' and namespace-uri()='DAV:']"));
+    static const QVector<QPair<QString, QString>> types = {
+        qMakePair(QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("calendar"))
+    };
 
-    return query;
+    return types;
 }
 
 QVector<XMLQueryBuilder::Ptr> CaldavProtocol::itemsQueries() const
@@ -245,6 +353,46 @@ QVector<XMLQueryBuilder::Ptr> CaldavProtocol::itemsQueries() const
     return ret;
 }
 
+XMLQueryBuilder::Ptr CaldavProtocol::combinedItemsQuery() const
+{
+    return XMLQueryBuilder::Ptr(new CaldavListQueryBuilder());
+}
+
+QStringList CaldavProtocol::itemsMimeTypes(DavCollection::ContentTypes contentTypes) const
+{
+    // A calendar without supported-calendar-component-set takes anything
+    const bool anything = contentTypes & DavCollection::Calendar;
+
+    QStringList mimeTypes;
+    if (anything || (contentTypes & DavCollection::Events)) {
+        mimeTypes << QStringLiteral("VEVENT");
+    }
+    if (anything || (contentTypes & DavCollection::Todos)) {
+        mimeTypes << QStringLiteral("VTODO");
+    }
+    if (anything || (contentTypes & DavCollection::Journal)) {
+        mimeTypes << QStringLiteral("VJOURNAL");
+    }
+    return mimeTypes;
+}
+
+QString CaldavProtocol::itemMimeType(const QDomElement &prop) const
+{
+    const QString data = Utils::firstChildElementNS(prop, QStringLiteral("urn:ietf:params:xml:ns:caldav"), QStringLiteral("calendar-data")).text();
+
+    static const QStringList types = {
+        QStringLiteral("VEVENT"), QStringLiteral("VTODO"), QStringLiteral("VJOURNAL")
+    };
+    for (const QString &type : types) {
+        const QString beginLine = QStringLiteral("BEGIN:") + type;
+        if (data.contains(beginLine)) {
+            return type;
+        }
+    }
+
+    return QString();
+}
+
 XMLQueryBuilder::Ptr CaldavProtocol::itemsReportQuery(const QStringList &urls) const
 {
     XMLQueryBuilder::Ptr ret(new CaldavMultigetQueryBuilder());
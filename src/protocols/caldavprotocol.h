@@ -27,13 +27,17 @@ public:
     CaldavProtocol();
     bool supportsPrincipals() const Q_DECL_OVERRIDE;
     bool supportsCTags() const Q_DECL_OVERRIDE;
+    bool supportsSyncCollection() const Q_DECL_OVERRIDE;
     bool useReport() const Q_DECL_OVERRIDE;
     bool useMultiget() const Q_DECL_OVERRIDE;
     QString principalHomeSet() const Q_DECL_OVERRIDE;
     QString principalHomeSetNS() const Q_DECL_OVERRIDE;
     KDAV2::XMLQueryBuilder::Ptr collectionsQuery() const Q_DECL_OVERRIDE;
-    QString collectionsXQuery() const Q_DECL_OVERRIDE;
+    QVector<QPair<QString, QString>> collectionResourceTypes() const Q_DECL_OVERRIDE;
     QVector<KDAV2::XMLQueryBuilder::Ptr> itemsQueries() const Q_DECL_OVERRIDE;
+    KDAV2::XMLQueryBuilder::Ptr combinedItemsQuery() const Q_DECL_OVERRIDE;
+    QStringList itemsMimeTypes(KDAV2::DavCollection::ContentTypes contentTypes) const Q_DECL_OVERRIDE;
+    QString itemMimeType(const QDomElement &prop) const Q_DECL_OVERRIDE;
     KDAV2::XMLQueryBuilder::Ptr itemsReportQuery(const QStringList &urls) const Q_DECL_OVERRIDE;
     QString responseNamespace() const Q_DECL_OVERRIDE;
     QString dataTagName() const Q_DECL_OVERRIDE;
@@ -131,6 +131,11 @@ bool CarddavProtocol::supportsCTags() const
     return true;
 }
 
+bool CarddavProtocol::supportsSyncCollection() const
+{
+    return true;
+}
+
 bool CarddavProtocol::useReport() const
 {
     return false;
@@ -156,11 +161,13 @@ XMLQueryBuilder::Ptr CarddavProtocol::collectionsQuery() const
     return XMLQueryBuilder::Ptr(new CarddavCollectionQueryBuilder());
 }
 
-QString CarddavProtocol::collectionsXQuery() const
+QVector<QPair<QString, QString>> CarddavProtocol::collectionResourceTypes() const
 {
-    const QString query(QStringLiteral("//*[local-name()='addressbook' and namespace-uri()='urn:ietf:params:xml:ns:carddav']/ancestor::*[local-name()='response' and namespace-uri()='DAV:']"));
+    static const QVector<QPair<QString, QString>> types = {
+        qMakePair(QStringLiteral("urn:ietf:params:xml:ns:carddav"), QStringLiteral("addressbook"))
+    };
 
-    return query;
+    return types;
 }
 
 QVector<XMLQueryBuilder::Ptr> CarddavProtocol::itemsQueries() const
@@ -27,12 +27,13 @@ public:
     CarddavProtocol();
     bool supportsPrincipals() const Q_DECL_OVERRIDE;
     bool supportsCTags() const Q_DECL_OVERRIDE;
+    bool supportsSyncCollection() const Q_DECL_OVERRIDE;
     bool useReport() const Q_DECL_OVERRIDE;
     bool useMultiget() const Q_DECL_OVERRIDE;
     QString principalHomeSet() const Q_DECL_OVERRIDE;
     QString principalHomeSetNS() const Q_DECL_OVERRIDE;
     KDAV2::XMLQueryBuilder::Ptr collectionsQuery() const Q_DECL_OVERRIDE;
-    QString collectionsXQuery() const Q_DECL_OVERRIDE;
+    QVector<QPair<QString, QString>> collectionResourceTypes() const Q_DECL_OVERRIDE;
     QVector<KDAV2::XMLQueryBuilder::Ptr> itemsQueries() const Q_DECL_OVERRIDE;
     KDAV2::XMLQueryBuilder::Ptr itemsReportQuery(const QStringList &urls) const Q_DECL_OVERRIDE;
     QString responseNamespace() const Q_DECL_OVERRIDE;
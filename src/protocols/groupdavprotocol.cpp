@@ -105,11 +105,15 @@ XMLQueryBuilder::Ptr GroupdavProtocol::collectionsQuery() const
     return XMLQueryBuilder::Ptr(new GroupdavCollectionQueryBuilder());
 }
 
-QString GroupdavProtocol::collectionsXQuery() const
+QVector<QPair<QString, QString>> GroupdavProtocol::collectionResourceTypes() const
 {
-    const QString query(QStringLiteral("//*[(local-name()='vevent-collection' or local-name()='vtodo-collection' or local-name()='vcard-collection') and namespace-uri()='http://groupdav.org/']/ancestor::*[local-name()='response' and namespace-uri()='DAV:']"));
+    static const QVector<QPair<QString, QString>> types = {
+        qMakePair(QStringLiteral("http://groupdav.org/"), QStringLiteral("vevent-collection")),
+        qMakePair(QStringLiteral("http://groupdav.org/"), QStringLiteral("vtodo-collection")),
+        qMakePair(QStringLiteral("http://groupdav.org/"), QStringLiteral("vcard-collection"))
+    };
 
-    return query;
+    return types;
 }
 
 QVector<XMLQueryBuilder::Ptr> GroupdavProtocol::itemsQueries() const
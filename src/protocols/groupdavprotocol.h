@@ -30,7 +30,7 @@ public:
     bool useReport() const Q_DECL_OVERRIDE;
     bool useMultiget() const Q_DECL_OVERRIDE;
     KDAV2::XMLQueryBuilder::Ptr collectionsQuery() const Q_DECL_OVERRIDE;
-    QString collectionsXQuery() const Q_DECL_OVERRIDE;
+    QVector<QPair<QString, QString>> collectionResourceTypes() const Q_DECL_OVERRIDE;
     QVector<KDAV2::XMLQueryBuilder::Ptr> itemsQueries() const Q_DECL_OVERRIDE;
 
     KDAV2::DavCollection::ContentTypes collectionContentTypes(const QDomElement &propstat) const Q_DECL_OVERRIDE;